@@ -0,0 +1,107 @@
+/*
+ * BackgroundCache.h
+ * Pre-rendered static page layers (grid, axis labels) for thermal printer
+ * The background depends only on the layout, so it is drawn once into a
+ * full-page layer and every band of every later job starts as a copy of
+ * it; only the curve is drawn per job.
+ * One cache may be shared by several print tasks: get() is serialised,
+ * and the returned layer is only read until the layout changes.
+ * The layer lives in PSRAM only: on boards without it (ESP32-C3) the
+ * cache stays unavailable and bands draw their own background, so no
+ * page-sized block is ever taken from internal RAM.
+ */
+
+#ifndef BACKGROUND_CACHE_H
+#define BACKGROUND_CACHE_H
+
+#include <Arduino.h>
+#include "BitmapCanvas.h"
+#include "JobArena.h"
+
+class BackgroundCache {
+private:
+  BitmapCanvas* layer;    // Full page (~80 KB)
+  uint8_t* layerMemory;   // Its buffer (PSRAM only)
+  uint32_t key;           // GraphGenerator::layoutKey() of the cached layer
+  bool unavailable;       // Allocation failed: stop retrying until release()
+  SemaphoreHandle_t lock; // Held while the layer is checked or redrawn
+
+  void freeLayer() {
+    delete layer;
+    layer = nullptr;
+    regionFree(layerMemory);
+    layerMemory = nullptr;
+  }
+
+  // Layer for the key, drawing it if needed (lock held)
+  template <class Generator>
+  const BitmapCanvas* lookup(Generator& generator, uint16_t width, uint16_t pageHeight,
+                             bool dashed) {
+    uint32_t wanted = generator.layoutKey(dashed);
+
+    if (layer && key == wanted &&
+        layer->getWidth() == width && layer->getHeight() == pageHeight) {
+      return layer;
+    }
+
+    if (unavailable) return nullptr;
+
+    if (!layer || layer->getWidth() != width || layer->getHeight() != pageHeight) {
+      freeLayer();
+      // No internal RAM fallback (unlike regionMalloc)
+      layerMemory = (uint8_t*)heap_caps_malloc(BitmapCanvas::bufferSize(width, pageHeight),
+                                               regionCaps(REGION_PSRAM));
+      if (!layerMemory) {
+        Serial.println("  ⚠ No PSRAM for the background cache, drawing per band");
+        unavailable = true;
+        return nullptr;
+      }
+      layer = new BitmapCanvas(width, pageHeight, layerMemory);
+    }
+
+    layer->clear();
+    layer->setOrigin(0);
+    generator.drawBackground(*layer, dashed);
+    key = wanted;
+
+    Serial.printf("  ✓ Background cached (rows %d-%d)\n",
+                  layer->getDirtyFirst(), layer->getDirtyLast());
+    return layer;
+  }
+
+public:
+  BackgroundCache() : layer(nullptr), layerMemory(nullptr), key(0), unavailable(false) {
+    lock = xSemaphoreCreateMutex();
+  }
+
+  ~BackgroundCache() {
+    freeLayer();
+    if (lock) vSemaphoreDelete(lock);
+  }
+
+  // Layer for the generator's layout, (re)rendered if the layout changed.
+  // Returns nullptr if the page does not fit in memory; callers then draw
+  // the background themselves.
+  template <class Generator>
+  const BitmapCanvas* get(Generator& generator, uint16_t width, uint16_t pageHeight,
+                          bool dashed) {
+    if (!lock) return nullptr;
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    const BitmapCanvas* result = lookup(generator, width, pageHeight, dashed);
+    xSemaphoreGive(lock);
+    return result;
+  }
+
+  // Drop the cached layer (e.g. to free PSRAM)
+  void release() {
+    if (!lock) return;
+    xSemaphoreTake(lock, portMAX_DELAY);
+    freeLayer();
+    key = 0;
+    unavailable = false;
+    xSemaphoreGive(lock);
+  }
+};
+
+#endif // BACKGROUND_CACHE_H
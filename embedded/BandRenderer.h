@@ -0,0 +1,194 @@
+/*
+ * BandRenderer.h
+ * Banded (scanline) page rendering for thermal printer
+ * Renders the graph a few rows at a time into a small band buffer and
+ * sends every finished band as its own GS v 0 strip, so the full-page
+ * canvas is never allocated.
+ */
+
+#ifndef BAND_RENDERER_H
+#define BAND_RENDERER_H
+
+#include <Arduino.h>
+#include "BitmapCanvas.h"
+#include "GraphGenerator.h"
+#include "ThermalPrinter.h"
+#include "BackgroundCache.h"
+
+// Rows per band (64 rows x 512 dots = 4 KB)
+#define BAND_ROWS_DEFAULT 64
+
+// Runs on the printer's sending task before band nextBand (> 0) goes out.
+// It may print something else in between (the previous band is complete
+// on the wire); returning false stops the page.
+typedef bool (*BandBoundaryHook)(uint16_t nextBand, ThermalPrinter& printer, void* ctx);
+
+template <class Canvas>
+class BasicBandRenderer {
+private:
+  BasicGraphGenerator<Canvas>& generator;
+  uint16_t width;
+  uint16_t pageHeight;
+  uint16_t bandRows;
+
+  bool gridDashed;
+  uint8_t curveThickness;
+  BackgroundCache* background;    // Optional cached static layers
+  
+  BandBoundaryHook boundaryHook;
+  void* boundaryCtx;
+
+public:
+  BasicBandRenderer(BasicGraphGenerator<Canvas>& gen, uint16_t w, uint16_t pageH,
+               uint16_t rows = BAND_ROWS_DEFAULT)
+    : generator(gen), width(w),
+      pageHeight(pageH), bandRows(rows),
+      gridDashed(true), curveThickness(1), background(nullptr),
+      boundaryHook(nullptr), boundaryCtx(nullptr) {}
+
+  // Page geometry is usable
+  bool isValid() const {
+    return width > 0 && bandRows > 0 && pageHeight > 0;
+  }
+
+  // Layer options
+  void setGridDashed(bool dashed) { gridDashed = dashed; }
+  void setCurveThickness(uint8_t thickness) { curveThickness = thickness; }
+  
+  // Start every band from a cached background instead of drawing the
+  // grid and labels (cache may be shared by all jobs with this layout)
+  void setBackgroundCache(BackgroundCache* cache) { background = cache; }
+  
+  // Preemption / cancellation point between bands (nullptr = none)
+  void setBandHook(BandBoundaryHook hook, void* ctx = nullptr) {
+    boundaryHook = hook;
+    boundaryCtx = ctx;
+  }
+  
+  // Run the band hook before band nextBand; false = stop the page
+  bool bandBoundary(uint16_t nextBand, ThermalPrinter& printer) {
+    return !boundaryHook || nextBand == 0 || boundaryHook(nextBand, printer, boundaryCtx);
+  }
+
+  // Number of bands needed for the page
+  uint16_t bandCount() const {
+    return (pageHeight + bandRows - 1) / bandRows;
+  }
+
+  // Rows held by band i (last band may be shorter)
+  uint16_t rowsInBand(uint16_t i) const {
+    uint16_t start = i * bandRows;
+    return min((uint16_t)bandRows, (uint16_t)(pageHeight - start));
+  }
+
+  // Render band i into a band buffer of at least getBandRows() rows.
+  // The curve must already be prepared with GraphGenerator::prepareCurve().
+  void renderBand(uint16_t i, Canvas& band) {
+    STATS_SCOPE(STAT_BAND_RENDER);
+    band.clear();
+    band.setOrigin(i * bandRows);
+
+    const BitmapCanvas* layer = background
+      ? background->get(generator, width, pageHeight, gridDashed) : nullptr;
+
+    generator.setCanvas(&band);
+    {
+      STATS_SCOPE(STAT_BACKGROUND);
+      if (layer) {
+        band.copyRowsFrom(*layer);
+      } else {
+        generator.drawBackground(band, gridDashed);
+      }
+    }
+    
+    STATS_SCOPE(STAT_CURVE);
+    generator.drawPreparedCurve(curveThickness);
+  }
+
+  // Send rendered band i. With raster compression on, the clean rows
+  // around the band's dirty range go out as paper feeds without being
+  // scanned, and a band nothing was drawn on is a pure feed.
+  // async: the strip is started with printBitmapAsync() (see poll()).
+  bool sendBand(uint16_t i, const Canvas& band, ThermalPrinter& printer, bool async = false) {
+    STATS_SCOPE(STAT_TRANSMIT);
+    int16_t rows = rowsInBand(i);
+    int16_t first = 0;
+    int16_t last = rows - 1;
+    
+    if (printer.getRasterCompression()) {
+      if (!band.hasDirtyRows() || band.getDirtyFirst() >= rows) {
+        printer.feedDots(rows);
+        return true;
+      }
+      first = band.getDirtyFirst();
+      last = min(last, band.getDirtyLast());
+      
+      if (first > 0) {
+        printer.feedDots(first);
+      }
+    }
+    
+    const uint8_t* strip = band.getData() + (uint32_t)first * band.getBytesPerLine();
+    bool ok = async ? printer.printBitmapAsync(width, last - first + 1, strip)
+                    : printer.printBitmap(width, last - first + 1, strip);
+    
+    if (ok && last < rows - 1) {
+      printer.feedDots(rows - 1 - last);
+    }
+    return ok;
+  }
+
+  // Render and print the whole page, one band at a time,
+  // through a band buffer allocated for the job
+  bool print(ThermalPrinter& printer) {
+    Canvas band(width, bandRows);
+    
+    if (!band.isValid()) {
+      Serial.println("  ✗ Band buffer not allocated!");
+      return false;
+    }
+
+    return print(printer, band);
+  }
+
+  // Same, through a caller-owned band buffer (e.g. a static FixedCanvas)
+  bool print(ThermalPrinter& printer, Canvas& band) {
+    if (!band.isValid() || band.getWidth() != width || band.getHeight() < bandRows) {
+      Serial.println("  ✗ Band buffer does not fit the page!");
+      return false;
+    }
+
+    uint16_t count = bandCount();
+
+    for (uint16_t i = 0; i < count; i++) {
+      if (!bandBoundary(i, printer)) {
+        Serial.printf("  ✗ Page stopped before band %d\n", i);
+        return false;
+      }
+      
+      renderBand(i, band);
+
+      if (!sendBand(i, band, printer)) {
+        Serial.printf("  ✗ Band %d transmission failed!\n", i);
+        return false;
+      }
+
+      // Progress indicator
+      if ((i + 1) % 5 == 0 || i + 1 == count) {
+        Serial.printf("  Progress: %d%%\n", ((i + 1) * 100) / count);
+      }
+    }
+
+    return true;
+  }
+
+  // Getters
+  uint16_t getWidth() const { return width; }
+  uint16_t getBandRows() const { return bandRows; }
+  uint16_t getPageHeight() const { return pageHeight; }
+};
+
+// Renderer for heap-allocated bands
+typedef BasicBandRenderer<BitmapCanvas> BandRenderer;
+
+#endif // BAND_RENDERER_H
@@ -9,65 +9,536 @@
 
 #include <Arduino.h>
 #include "Font5x7.h"
+#include "GlyphCache.h"
+#include "BlendOps.h"
+#include "Stats.h"
 
-class BitmapCanvas {
-private:
+// Attribute for statically allocated canvases, e.g. EXT_RAM_BSS_ATTR to
+// place a FixedCanvas in PSRAM or DRAM_ATTR to force internal RAM
+#ifndef CANVAS_STORAGE_ATTR
+#define CANVAS_STORAGE_ATTR
+#endif
+
+// Runtime-sized storage: heap buffer, dimensions chosen at construction.
+// A caller-provided buffer of bufferSize() bytes (e.g. from a JobArena or
+// PSRAM) is used instead when given, and is not freed.
+class CanvasHeapStorage {
+protected:
   uint16_t width;
   uint16_t height;
   uint16_t bytesPerLine;
   uint8_t* data;
+  uint8_t* dirty;       // One bit per row, stored after the pixels
+  bool owned;           // data was malloc'd here
   
-public:
-  BitmapCanvas(uint16_t w, uint16_t h) : width(w), height(h) {
-    bytesPerLine = width / 8;
-    size_t totalBytes = bytesPerLine * height;
+  CanvasHeapStorage(uint16_t w, uint16_t h, uint8_t* buffer = nullptr)
+    : width(w), height(h), owned(buffer == nullptr) {
+    bytesPerLine = (width + 7) / 8;
+    size_t totalBytes = (size_t)bytesPerLine * height;
     
-    Serial.printf("  Allocating %d bytes for canvas...\n", totalBytes);
-    data = (uint8_t*)malloc(totalBytes);
+    if (buffer) {
+      data = buffer;
+    } else {
+      Serial.printf("  Allocating %d bytes for canvas...\n", totalBytes);
+      STATS_SCOPE(STAT_CANVAS_ALLOC);
+      data = (uint8_t*)malloc(bufferSize(w, h));
+    }
+    dirty = data ? data + totalBytes : nullptr;
     
     if (!data) {
       Serial.println("  ✗ Canvas allocation failed!");
       width = 0;
       height = 0;
       bytesPerLine = 0;
-    } else {
+    } else if (owned) {
       Serial.println("  ✓ Canvas allocated");
     }
   }
   
-  ~BitmapCanvas() {
-    if (data) {
+  ~CanvasHeapStorage() {
+    if (data && owned) {
       free(data);
       data = nullptr;
+      dirty = nullptr;
+    }
+  }
+  
+  bool hasData() const { return data != nullptr; }
+  
+public:
+  // Bytes of a w x h canvas buffer (pixels + dirty row bits). Rows are
+  // padded to whole bytes; the pad bits are never drawn and stay 0.
+  static size_t bufferSize(uint16_t w, uint16_t h) {
+    return (size_t)((w + 7) / 8) * h + (h + 7) / 8;
+  }
+  
+private:
+  // Owns its buffer: not copyable
+  CanvasHeapStorage(const CanvasHeapStorage&);
+  CanvasHeapStorage& operator=(const CanvasHeapStorage&);
+};
+
+// Compile-time storage: W x H buffer embedded in the object, no heap.
+// Dimensions are constants, so row offsets fold to shifts (W = 512:
+// y * 64) and bounds checks against constants.
+template <uint16_t W, uint16_t H>
+class CanvasStaticStorage {
+protected:
+  static const uint16_t width = W;
+  static const uint16_t height = H;
+  static const uint16_t bytesPerLine = (W + 7) / 8;
+  uint8_t data[(uint32_t)((W + 7) / 8) * H];
+  uint8_t dirty[(H + 7) / 8];
+  
+  CanvasStaticStorage() {}
+  
+  bool hasData() const { return true; }
+};
+
+template <uint16_t W, uint16_t H> const uint16_t CanvasStaticStorage<W, H>::width;
+template <uint16_t W, uint16_t H> const uint16_t CanvasStaticStorage<W, H>::height;
+template <uint16_t W, uint16_t H> const uint16_t CanvasStaticStorage<W, H>::bytesPerLine;
+
+// Rows of path extents a thick line keeps (max thickness LINE_SPAN_RING - 1)
+#define LINE_SPAN_RING 16
+
+// Dashed lines: LINE_DASH_ROWS scanlines drawn, then as many skipped
+// (power of 2; counted in page rows, so bands join seamlessly)
+#define LINE_DASH_ROWS 8
+
+// Thick line / polyline rasteriser for y-monotone paths. Walks the
+// Bresenham path of every segment, records the x extent of the path on
+// each row, and fills one span per scanline: the union of the
+// thickness x thickness squares the old per-pixel stamping drew.
+template <class Canvas>
+class ThickPolyline {
+private:
+  struct Extent {
+    int16_t minX;
+    int16_t maxX;
+  };
+  
+  Canvas* canvas;
+  int16_t half;
+  Extent rows[LINE_SPAN_RING];   // Path extents, indexed by row % ring
+  int16_t firstRow;              // Path rows are [firstRow, lastRow]
+  int16_t lastRow;
+  int16_t nextScan;              // Next scanline to fill
+  int16_t penX, penY;
+  bool active;
+  bool flipped;                  // Run walks upward: rows are stored as -y
+  bool moved;                    // Run has more than its start point
+  bool dashed;
+  
+  Extent& row(int16_t y) {
+    return rows[(uint16_t)y % LINE_SPAN_RING];
+  }
+  
+  // Fill scanline y from the path rows within half of it
+  void emit(int16_t y) {
+    int16_t r0 = max((int16_t)(y - half), firstRow);
+    int16_t r1 = min((int16_t)(y + half), lastRow);
+    if (r0 > r1) return;
+    
+    int16_t x0 = row(r0).minX;
+    int16_t x1 = row(r0).maxX;
+    for (int16_t r = r0 + 1; r <= r1; r++) {
+      x0 = min(x0, row(r).minX);
+      x1 = max(x1, row(r).maxX);
+    }
+    int16_t pageY = flipped ? -y : y;
+    if (dashed && (pageY & LINE_DASH_ROWS)) return;
+    canvas->fillSpan(pageY, x0 - half, x1 + half + 1);
+  }
+  
+  // Add a path point; y (run row) never decreases within one run
+  void plot(int16_t x, int16_t y) {
+    if (flipped) y = -y;
+    if (y == lastRow) {
+      Extent& e = row(y);
+      if (x < e.minX) e.minX = x;
+      if (x > e.maxX) e.maxX = x;
+      return;
+    }
+    
+    // Row lastRow is complete: fill every scanline it was the last input for
+    lastRow = y;
+    row(y).minX = x;
+    row(y).maxX = x;
+    while (nextScan + half < lastRow) {
+      emit(nextScan++);
+    }
+  }
+  
+  void start(int16_t x, int16_t y, bool upward = false) {
+    flipped = upward;
+    penX = x;
+    penY = y;
+    if (upward) y = -y;
+    firstRow = y;
+    lastRow = y;
+    nextScan = y - half;
+    row(y).minX = x;
+    row(y).maxX = x;
+    active = true;
+    moved = false;
+  }
+  
+  // Bresenham walk, first point excluded (already plotted)
+  void walk(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+    int16_t dx = abs(x1 - x0);
+    int16_t dy = -abs(y1 - y0);
+    int16_t sx = (x0 < x1) ? 1 : -1;
+    int16_t sy = (y0 < y1) ? 1 : -1;
+    int16_t err = dx + dy;
+    
+    while (x0 != x1 || y0 != y1) {
+      int16_t e2 = 2 * err;
+      if (e2 >= dy) {
+        err += dy;
+        x0 += sx;
+      }
+      if (e2 <= dx) {
+        err += dx;
+        y0 += sy;
+      }
+      plot(x0, y0);
+      moved = true;
+    }
+  }
+  
+public:
+  ThickPolyline(Canvas& cnv, uint8_t thickness = 1, bool dash = false)
+    : canvas(nullptr), active(false) {
+    begin(cnv, thickness, dash);
+  }
+  
+  // Unbound line (e.g. one of several drawn side by side): call begin()
+  ThickPolyline() : canvas(nullptr), half(0), firstRow(0), lastRow(0), nextScan(0),
+                    penX(0), penY(0), active(false), flipped(false), moved(false),
+                    dashed(false) {}
+  
+  ~ThickPolyline() { finish(); }
+  
+  // Bind to a canvas and pen; ends any path in progress
+  void begin(Canvas& cnv, uint8_t thickness = 1, bool dash = false) {
+    finish();
+    canvas = &cnv;
+    half = min((int16_t)(thickness / 2), (int16_t)((LINE_SPAN_RING - 2) / 2));
+    firstRow = lastRow = nextScan = 0;
+    penX = penY = 0;
+    active = flipped = moved = false;
+    dashed = dash;
+  }
+  
+  // Start a new path at (x, y)
+  void moveTo(int16_t x, int16_t y) {
+    finish();
+    start(x, y);
+  }
+  
+  // Extend the path; shared vertices are walked once
+  void lineTo(int16_t x, int16_t y) {
+    if (!active) {
+      start(x, y);
+      return;
+    }
+    
+    if ((y < penY) != flipped && y != penY) {
+      // Direction change: continue as a new run from the pen
+      int16_t fromX = penX, fromY = penY;
+      if (moved) finish();
+      start(fromX, fromY, y < fromY);
+    }
+    
+    walk(penX, penY, x, y);
+    penX = x;
+    penY = y;
+  }
+  
+  // Fill the remaining scanlines of the current path
+  void finish() {
+    if (!active) return;
+    while (nextScan <= lastRow + half) {
+      emit(nextScan++);
+    }
+    active = false;
+  }
+};
+
+// Canvas drawing on top of a storage policy (see BitmapCanvas / FixedCanvas)
+template <class Storage>
+class BasicBitmapCanvas : public Storage {
+private:
+  using Storage::width;
+  using Storage::height;
+  using Storage::bytesPerLine;
+  using Storage::data;
+  using Storage::dirty;
+  
+  int16_t originY;      // Page row held in buffer row 0 (banded rendering)
+  
+  // Buffer rows written since the last clear(): bitmap plus [first, last]
+  int16_t dirtyFirst;
+  int16_t dirtyLast;
+  
+  void markRow(int16_t y) {
+    dirty[y >> 3] |= 0x80 >> (y & 7);
+    if (y < dirtyFirst) dirtyFirst = y;
+    if (y > dirtyLast) dirtyLast = y;
+  }
+  
+  // Mark buffer rows [y0, y1)
+  void markRows(int16_t y0, int16_t y1) {
+    for (int16_t y = y0; y < y1; y++) {
+      markRow(y);
     }
   }
   
-  // Clear canvas to white
+  // Fresh buffers hold garbage: the first clear() wipes every row
+  void markAllDirty() {
+    if (!isValid()) return;
+    memset(dirty, 0xFF, (height + 7) / 8);
+    dirtyFirst = 0;
+    dirtyLast = height - 1;
+  }
+  
+public:
+  BasicBitmapCanvas() : originY(0), dirtyFirst(0), dirtyLast(-1) { markAllDirty(); }
+  BasicBitmapCanvas(uint16_t w, uint16_t h)
+    : Storage(w, h), originY(0), dirtyFirst(0), dirtyLast(-1) { markAllDirty(); }
+  BasicBitmapCanvas(uint16_t w, uint16_t h, uint8_t* buffer)
+    : Storage(w, h, buffer), originY(0), dirtyFirst(0), dirtyLast(-1) { markAllDirty(); }
+  
+  // Clear canvas to white. Only rows drawn on since the last clear are
+  // touched, in runs of consecutive dirty rows.
   void clear() {
-    if (data) {
-      memset(data, 0, bytesPerLine * height);
+    if (!isValid()) return;
+    
+    int16_t y = dirtyFirst;
+    while (y <= dirtyLast) {
+      if (!isRowDirty(y)) {
+        y++;
+        continue;
+      }
+      
+      int16_t start = y;
+      while (y <= dirtyLast && isRowDirty(y)) y++;
+      memset(data + (uint32_t)start * bytesPerLine, 0, (uint32_t)(y - start) * bytesPerLine);
+    }
+    
+    if (dirtyLast >= dirtyFirst) {
+      memset(dirty + (dirtyFirst >> 3), 0, (dirtyLast >> 3) - (dirtyFirst >> 3) + 1);
+    }
+    dirtyFirst = height;
+    dirtyLast = -1;
+  }
+  
+  // Copy the rows src (same width, any storage) has drawn on into this
+  // window, replacing what is there. Rows src never drew on are skipped.
+  template <class Other>
+  void copyRowsFrom(const Other& src) {
+    if (!isValid() || !src.isValid() || src.getWidth() != width || !src.hasDirtyRows()) {
+      return;
+    }
+    
+    int16_t srcOrigin = src.getOriginY();
+    int16_t y0 = max(originY, (int16_t)(srcOrigin + src.getDirtyFirst()));
+    int16_t y1 = min((int16_t)(originY + height), (int16_t)(srcOrigin + src.getDirtyLast() + 1));
+    
+    int16_t y = y0;
+    while (y < y1) {
+      if (!src.isRowDirty(y - srcOrigin)) {
+        y++;
+        continue;
+      }
+      
+      int16_t start = y;
+      while (y < y1 && src.isRowDirty(y - srcOrigin)) y++;
+      memcpy(data + (uint32_t)(start - originY) * bytesPerLine,
+             src.getData() + (uint32_t)(start - srcOrigin) * bytesPerLine,
+             (uint32_t)(y - start) * bytesPerLine);
+      markRows(start - originY, y - originY);
     }
   }
   
+  // Move the canvas window to page row y
+  // Drawing calls keep using page coordinates; anything outside
+  // rows [y, y + height) is clipped. Used to render a page band by band.
+  void setOrigin(int16_t y) {
+    originY = y;
+  }
+  
+  // True if page rows [y, y + rows) overlap the canvas window
+  bool intersectsRows(int16_t y, int16_t rows) const {
+    return (y < originY + (int16_t)height) && (y + rows > originY);
+  }
+  
   // Set a single pixel (black)
   void setPixel(int16_t x, int16_t y) {
-    if (!data || x < 0 || x >= width || y < 0 || y >= height) {
+    y -= originY;
+    if (!isValid() || x < 0 || x >= width || y < 0 || y >= height) {
       return;
     }
     
     uint32_t byteIndex = (x / 8) + y * bytesPerLine;
     uint8_t bitPosition = x & 7;
     data[byteIndex] |= (0x80 >> bitPosition);
+    markRow(y);
+  }
+  
+  // OR an 8-pixel pattern into pixels [x0, x1) of row y.
+  // Bit 7 of the pattern lands on x % 8 == 0, so patterns stay aligned
+  // to absolute x. The span is clipped once, edges are masked and whole
+  // 32-bit words are written in the middle.
+  void fillSpan(int16_t y, int16_t x0, int16_t x1, uint8_t pattern = 0xFF) {
+    y -= originY;
+    if (!isValid() || y < 0 || y >= height) return;
+    if (x0 < 0) x0 = 0;
+    if (x1 > (int16_t)width) x1 = width;
+    if (x0 >= x1) return;
+    
+    markRow(y);
+    uint8_t* row = data + (uint32_t)y * bytesPerLine;
+    int16_t b0 = x0 >> 3;
+    int16_t b1 = (x1 - 1) >> 3;
+    uint8_t leftMask = 0xFF >> (x0 & 7);
+    uint8_t rightMask = 0xFF << (7 - ((x1 - 1) & 7));
+    
+    if (b0 == b1) {
+      row[b0] |= pattern & leftMask & rightMask;
+      return;
+    }
+    
+    row[b0] |= pattern & leftMask;
+    row[b1] |= pattern & rightMask;
+    
+    uint8_t* p = row + b0 + 1;
+    uint8_t* end = row + b1;
+    
+    while (p < end && ((uintptr_t)p & 3)) {
+      *p++ |= pattern;
+    }
+    
+    uint32_t pattern32 = (uint32_t)pattern * 0x01010101u;
+    while (p + 4 <= end) {
+      *(uint32_t*)p |= pattern32;
+      p += 4;
+    }
+    
+    while (p < end) {
+      *p++ |= pattern;
+    }
+  }
+  
+  // Fill (BLEND_OR), clear (BLEND_CLEAR) or invert (BLEND_XOR) the
+  // w x h rectangle at (x, y); edges are masked, the middle is whole words
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, BlendOp op = BLEND_OR) {
+    int16_t x0 = max(x, (int16_t)0);
+    int16_t x1 = min((int16_t)(x + w), (int16_t)width);
+    int16_t y0 = max((int16_t)(y - originY), (int16_t)0);
+    int16_t y1 = min((int16_t)(y + h - originY), (int16_t)height);
+    if (!isValid() || x0 >= x1 || y0 >= y1) return;
+    
+    bool sets = blendSetsBits(op);
+    for (int16_t r = y0; r < y1; r++) {
+      if (!sets && !isRowDirty(r)) continue;    // Clean rows are already white
+      blendSpan(data + (uint32_t)r * bytesPerLine, x0, x1, op);
+    }
+    if (sets) markRows(y0, y1);
+  }
+  
+  void clearRect(int16_t x, int16_t y, int16_t w, int16_t h) { fillRect(x, y, w, h, BLEND_CLEAR); }
+  void invertRect(int16_t x, int16_t y, int16_t w, int16_t h) { fillRect(x, y, w, h, BLEND_XOR); }
+  
+  // Blend a 1-bpp bitmap (rows MSB first, stride bytes apart) at (x, y):
+  // w x h dots, starting srcX dots into each source row. Any x works; the
+  // rows are shifted into place 32 bits at a time. Logos, barcodes...
+  void blit(const uint8_t* bits, uint16_t stride, uint16_t w, uint16_t h,
+            int16_t x, int16_t y, BlendOp op = BLEND_OR, uint16_t srcX = 0) {
+    int16_t c0 = x < 0 ? -x : 0;
+    int16_t c1 = min((int16_t)w, (int16_t)(width - x));
+    int16_t r0 = max((int16_t)(originY - y), (int16_t)0);
+    int16_t r1 = min((int16_t)h, (int16_t)(originY + height - y));
+    if (!isValid() || !bits || c0 >= c1 || r0 >= r1) return;
+    
+    int16_t dx = x + c0;
+    uint16_t sx = srcX + c0;
+    uint8_t* p = data + (uint32_t)(y + r0 - originY) * bytesPerLine + (dx >> 3);
+    const uint8_t* s = bits + (uint32_t)r0 * stride + (sx >> 3);
+    for (int16_t r = r0; r < r1; r++) {
+      blendBits(p, dx & 7, s, sx & 7, c1 - c0, op);
+      p += bytesPerLine;
+      s += stride;
+    }
+    if (blendSetsBits(op)) markRows(y + r0 - originY, y + r1 - originY);
+  }
+  
+  // Blend the w x h area of src (any storage) at (srcX, srcY) to (x, y)
+  template <class Other>
+  void blit(const Other& src, int16_t srcX, int16_t srcY, int16_t w, int16_t h,
+            int16_t x, int16_t y, BlendOp op = BLEND_OR) {
+    if (!src.isValid()) return;
+    if (srcX < 0) { w += srcX; x -= srcX; srcX = 0; }
+    if (srcY < 0) { h += srcY; y -= srcY; srcY = 0; }
+    w = min(w, (int16_t)(src.getWidth() - srcX));
+    h = min(h, (int16_t)(src.getHeight() - srcY));
+    if (w <= 0 || h <= 0) return;
+    
+    uint16_t stride = src.getBytesPerLine();
+    blit(src.getData() + (uint32_t)srcY * stride, stride, w, h, x, y, op, srcX);
+  }
+  
+  // Blend src (same width, any storage) into the page rows both windows
+  // hold, whole rows 32 bits at a time: layers, bands, masks. Rows src
+  // never drew on are blank, so they are skipped (AND / COPY clear them).
+  template <class Other>
+  void combine(const Other& src, BlendOp op = BLEND_OR) {
+    if (!isValid() || !src.isValid() || src.getWidth() != width) return;
+    
+    int16_t srcOrigin = src.getOriginY();
+    int16_t y0 = max(originY, srcOrigin);
+    int16_t y1 = min((int16_t)(originY + height), (int16_t)(srcOrigin + src.getHeight()));
+    bool blanks = op == BLEND_AND || op == BLEND_COPY;
+    
+    int16_t y = y0;
+    while (y < y1) {
+      // Run of rows with the same src state: one kernel call
+      bool drawn = src.isRowDirty(y - srcOrigin);
+      int16_t start = y;
+      while (y < y1 && src.isRowDirty(y - srcOrigin) == drawn) y++;
+      
+      uint8_t* d = data + (uint32_t)(start - originY) * bytesPerLine;
+      uint32_t bytes = (uint32_t)(y - start) * bytesPerLine;
+      if (drawn) {
+        blendBytes(d, src.getData() + (uint32_t)(start - srcOrigin) * bytesPerLine, bytes, op);
+        if (blendSetsBits(op)) markRows(start - originY, y - originY);
+      } else if (blanks) {
+        memset(d, 0, bytes);
+      }
+    }
   }
   
   // Draw vertical line
   void drawVerticalLine(int16_t x, int16_t y_start = 0, int16_t y_end = -1, bool dashed = false) {
-    if (y_end == -1) y_end = height;
+    if (y_end == -1) y_end = originY + height;
+    
+    // Clip to the canvas window
+    if (y_start < originY) y_start = originY;
+    if (y_end > originY + (int16_t)height) y_end = originY + height;
+    if (!isValid() || x < 0 || x >= width || y_start >= y_end) return;
+    
+    // Walk one column: fixed bit, pointer steps by bytesPerLine
+    uint8_t bit = 0x80 >> (x & 7);
+    uint8_t* p = data + (uint32_t)(y_start - originY) * bytesPerLine + (x >> 3);
+    markRows(y_start - originY, y_end - originY);
     
     for (int16_t y = y_start; y < y_end; y++) {
-      if (!dashed || (y / 4) % 2 == 0) {
-        setPixel(x, y);
+      // Dash: 4 pixels on, 4 off (page rows are never negative)
+      if (!dashed || (y & 4) == 0) {
+        *p |= bit;
       }
+      p += bytesPerLine;
     }
   }
   
@@ -75,19 +546,51 @@ public:
   void drawHorizontalLine(int16_t y, int16_t x_start = 0, int16_t x_end = -1, bool dashed = false) {
     if (x_end == -1) x_end = width;
     
-    for (int16_t x = x_start; x < x_end; x++) {
-      if (!dashed || (x / 4) % 2 == 0) {
-        setPixel(x, y);
+    // Dash: 4 pixels on, 4 off, i.e. 0xF0 per byte
+    fillSpan(y, x_start, x_end, dashed ? 0xF0 : 0xFF);
+  }
+  
+  // OR one cached glyph at (x, y); caller guarantees x range fits
+  void blitGlyph(const GlyphSlot& slot, uint8_t idx, int16_t x, int16_t y) {
+    const uint32_t* bits = slot.bits + idx * slot.rows;
+    
+    // Clip rows to the canvas window
+    int16_t r0 = originY - y;
+    int16_t r1 = originY + (int16_t)height - y;
+    if (r0 < 0) r0 = 0;
+    if (r1 > slot.rows) r1 = slot.rows;
+    
+    uint8_t shift = x & 7;
+    uint8_t nbytes = (shift + slot.cols + 7) >> 3;
+    uint8_t* p = data + (uint32_t)(y + r0 - originY) * bytesPerLine + (x >> 3);
+    markRows(y + r0 - originY, y + r1 - originY);
+    
+    for (int16_t r = r0; r < r1; r++) {
+      uint64_t v = ((uint64_t)bits[r] << 32) >> shift;
+      for (uint8_t k = 0; k < nbytes; k++) {
+        p[k] |= (uint8_t)(v >> (56 - 8 * k));
       }
+      p += bytesPerLine;
     }
   }
   
   // Draw character from font
   void drawChar(char c, int16_t x, int16_t y, uint8_t size = 1, bool rotate90 = false) {
-    if (!data) return;
+    if (!isValid()) return;
     
-    const uint8_t* glyph = getFont5x7Char(c);
-    if (!glyph) return;
+    if (!intersectsRows(y, 8 * size)) return;
+    
+    int8_t idx = getCharIndex(c);
+    if (idx < 0) return;
+    
+    // Fast path: blit pre-rendered rows when fully inside horizontally
+    const GlyphSlot* slot = GlyphCache::get(size, rotate90);
+    if (slot && x >= 0 && x + slot->cols <= (int16_t)width) {
+      blitGlyph(*slot, idx, x, y);
+      return;
+    }
+    
+    const uint8_t* glyph = font5x7_data[idx];
     
     if (rotate90) {
       // Rotate 90° clockwise
@@ -143,42 +646,38 @@ public:
     }
   }
   
-  // Draw thick line using Bresenham's algorithm
+  // Draw thick line (Bresenham path, one span per scanline)
   void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t thickness = 1) {
-    int16_t dx = abs(x1 - x0);
-    int16_t dy = -abs(y1 - y0);
-    int16_t sx = (x0 < x1) ? 1 : -1;
-    int16_t sy = (y0 < y1) ? 1 : -1;
-    int16_t err = dx + dy;
-    
-    while (true) {
-      // Draw thick point
-      int16_t halfThick = thickness / 2;
-      for (int16_t ty = -halfThick; ty <= halfThick; ty++) {
-        for (int16_t tx = -halfThick; tx <= halfThick; tx++) {
-          setPixel(x0 + tx, y0 + ty);
-        }
-      }
-      
-      if (x0 == x1 && y0 == y1) break;
-      
-      int16_t e2 = 2 * err;
-      if (e2 >= dy) {
-        err += dy;
-        x0 += sx;
-      }
-      if (e2 <= dx) {
-        err += dx;
-        y0 += sy;
-      }
-    }
+    ThickPolyline<BasicBitmapCanvas> line(*this, thickness);
+    line.moveTo(x0, y0);
+    line.lineTo(x1, y1);
   }
+
   
   // Getters
   uint16_t getWidth() const { return width; }
   uint16_t getHeight() const { return height; }
+  uint16_t getBytesPerLine() const { return bytesPerLine; }
+  int16_t getOriginY() const { return originY; }
   const uint8_t* getData() const { return data; }
-  bool isValid() const { return data != nullptr; }
+  bool isValid() const { return Storage::hasData(); }
+  
+  // Dirty rows (buffer rows; add getOriginY() for page rows). A dirty row
+  // was drawn on since the last clear(); a clean row is known blank.
+  bool isRowDirty(int16_t row) const {
+    return (dirty[row >> 3] & (0x80 >> (row & 7))) != 0;
+  }
+  bool hasDirtyRows() const { return dirtyLast >= dirtyFirst; }
+  int16_t getDirtyFirst() const { return dirtyFirst; }
+  int16_t getDirtyLast() const { return dirtyLast; }
 };
 
+// Heap-backed canvas with runtime dimensions (dynamic layouts, bands)
+typedef BasicBitmapCanvas<CanvasHeapStorage> BitmapCanvas;
+
+// Canvas with compile-time dimensions and embedded storage:
+//   CANVAS_STORAGE_ATTR static FixedCanvas<512, 1280> page;
+template <uint16_t W, uint16_t H>
+using FixedCanvas = BasicBitmapCanvas<CanvasStaticStorage<W, H> >;
+
 #endif // BITMAP_CANVAS_H
@@ -0,0 +1,268 @@
+/*
+ * BlendOps.h
+ * Word-wide 1-bpp blend kernels for thermal printer canvases
+ * Rows are MSB-first bit strings (bit 7 of byte 0 is the leftmost dot).
+ * Byte-aligned rows are combined 32 bits at a time; rows at a bit offset
+ * are shifted through a 32-bit window, so stamping a logo anywhere costs
+ * one load / shift / store per word. Used by BitmapCanvas::blit(),
+ * combine() and fillRect().
+ *
+ * Define CANVAS_USE_PIE on an ESP32-S3 to run 16-byte aligned runs on
+ * the PIE 128-bit vector unit (EE.VLD / EE.ORQ ... / EE.VST).
+ */
+
+#ifndef BLEND_OPS_H
+#define BLEND_OPS_H
+
+#include <Arduino.h>
+
+#if defined(CANVAS_USE_PIE) && !defined(CONFIG_IDF_TARGET_ESP32S3)
+#undef CANVAS_USE_PIE
+#endif
+
+// dst = dst op src, per bit
+enum BlendOp {
+  BLEND_OR = 0,     // Draw black: d | s
+  BLEND_AND,        // Mask: d & s
+  BLEND_XOR,        // Invert where s is black: d ^ s
+  BLEND_CLEAR,      // Erase where s is black: d & ~s
+  BLEND_COPY        // Replace: s
+};
+
+// True if the op can turn a white dot black (dirty rows need marking)
+inline bool blendSetsBits(uint8_t op) {
+  return op == BLEND_OR || op == BLEND_XOR || op == BLEND_COPY;
+}
+
+template <uint8_t Op>
+inline uint32_t blendWord(uint32_t d, uint32_t s) {
+  switch (Op) {
+    case BLEND_OR:    return d | s;
+    case BLEND_AND:   return d & s;
+    case BLEND_XOR:   return d ^ s;
+    case BLEND_CLEAR: return d & ~s;
+    default:          return s;
+  }
+}
+
+// Blend under a mask: dots outside m are kept
+template <uint8_t Op>
+inline uint8_t blendMasked(uint8_t d, uint8_t s, uint8_t m) {
+  return (d & ~m) | ((uint8_t)blendWord<Op>(d, s) & m);
+}
+
+inline uint32_t loadWord(const uint8_t* p) {
+  uint32_t v;
+  memcpy(&v, p, 4);
+  return v;
+}
+
+inline void storeWord(uint8_t* p, uint32_t v) {
+  memcpy(p, &v, 4);
+}
+
+#ifdef CANVAS_USE_PIE
+// 16-byte blocks, both pointers 16-byte aligned; returns blocks done
+template <uint8_t Op>
+inline size_t blendBlocksPie(uint8_t* dst, const uint8_t* src, size_t blocks) {
+  for (size_t i = 0; i < blocks; i++) {
+    switch (Op) {
+      case BLEND_OR:
+        asm volatile("ee.vld.128.ip q0, %0, 16\n"
+                     "ee.vld.128.ip q1, %1, 0\n"
+                     "ee.orq q0, q0, q1\n"
+                     "ee.vst.128.ip q0, %1, 16\n"
+                     : "+r"(src), "+r"(dst) : : "memory");
+        break;
+      case BLEND_AND:
+        asm volatile("ee.vld.128.ip q0, %0, 16\n"
+                     "ee.vld.128.ip q1, %1, 0\n"
+                     "ee.andq q0, q0, q1\n"
+                     "ee.vst.128.ip q0, %1, 16\n"
+                     : "+r"(src), "+r"(dst) : : "memory");
+        break;
+      case BLEND_XOR:
+        asm volatile("ee.vld.128.ip q0, %0, 16\n"
+                     "ee.vld.128.ip q1, %1, 0\n"
+                     "ee.xorq q0, q0, q1\n"
+                     "ee.vst.128.ip q0, %1, 16\n"
+                     : "+r"(src), "+r"(dst) : : "memory");
+        break;
+      case BLEND_CLEAR:
+        asm volatile("ee.vld.128.ip q0, %0, 16\n"
+                     "ee.vld.128.ip q1, %1, 0\n"
+                     "ee.notq q0, q0\n"
+                     "ee.andq q0, q0, q1\n"
+                     "ee.vst.128.ip q0, %1, 16\n"
+                     : "+r"(src), "+r"(dst) : : "memory");
+        break;
+      default:
+        asm volatile("ee.vld.128.ip q0, %0, 16\n"
+                     "ee.vst.128.ip q0, %1, 16\n"
+                     : "+r"(src), "+r"(dst) : : "memory");
+        break;
+    }
+  }
+  return blocks;
+}
+#endif
+
+// dst[0, n) = dst op src[0, n): byte-aligned rows (whole band or page
+// rows are contiguous, so a run of rows is one call)
+template <uint8_t Op>
+inline void blendBytesT(uint8_t* dst, const uint8_t* src, size_t n) {
+  while (n && ((uintptr_t)dst & 3)) {
+    *dst = (uint8_t)blendWord<Op>(*dst, *src++);
+    dst++;
+    n--;
+  }
+
+#ifdef CANVAS_USE_PIE
+  if ((((uintptr_t)dst ^ (uintptr_t)src) & 15) == 0) {
+    while (n >= 4 && ((uintptr_t)dst & 15)) {
+      *(uint32_t*)dst = blendWord<Op>(*(uint32_t*)dst, *(const uint32_t*)src);
+      dst += 4;
+      src += 4;
+      n -= 4;
+    }
+    size_t done = blendBlocksPie<Op>(dst, src, n >> 4) << 4;
+    dst += done;
+    src += done;
+    n -= done;
+  }
+#endif
+
+  if (((uintptr_t)src & 3) == 0) {
+    for (; n >= 4; n -= 4) {
+      *(uint32_t*)dst = blendWord<Op>(*(uint32_t*)dst, *(const uint32_t*)src);
+      dst += 4;
+      src += 4;
+    }
+  } else {
+    for (; n >= 4; n -= 4) {
+      *(uint32_t*)dst = blendWord<Op>(*(uint32_t*)dst, loadWord(src));
+      dst += 4;
+      src += 4;
+    }
+  }
+
+  while (n--) {
+    *dst = (uint8_t)blendWord<Op>(*dst, *src++);
+    dst++;
+  }
+}
+
+// Bits [dstBit, dstBit + w) of dst = themselves op bits [srcBit, srcBit + w)
+// of src (bit offsets 0..7 from the first byte). No source byte past
+// the last bit is read.
+template <uint8_t Op>
+inline void blendBitsT(uint8_t* dst, uint8_t dstBit, const uint8_t* src, uint8_t srcBit,
+                       uint16_t w) {
+  if (w == 0) return;
+  if (dstBit == srcBit) {
+    // Same phase: masked edges, byte-aligned middle
+    uint16_t n = (dstBit + w + 7) >> 3;
+    uint8_t first = 0xFF >> dstBit;
+    uint8_t last = 0xFF << ((8 - ((dstBit + w) & 7)) & 7);
+    if (n == 1) {
+      *dst = blendMasked<Op>(*dst, *src, first & last);
+      return;
+    }
+    dst[0] = blendMasked<Op>(dst[0], src[0], first);
+    blendBytesT<Op>(dst + 1, src + 1, n - 2);
+    dst[n - 1] = blendMasked<Op>(dst[n - 1], src[n - 1], last);
+    return;
+  }
+
+  // Dst byte k takes src bytes base + k and base + k + 1, shifted by sh
+  int16_t srcBytes = (srcBit + w + 7) >> 3;
+  int8_t rel = (int8_t)srcBit - (int8_t)dstBit;
+  int16_t base = rel < 0 ? -1 : 0;
+  uint8_t sh = rel < 0 ? rel + 8 : rel;
+  uint16_t n = (dstBit + w + 7) >> 3;
+  uint8_t lastMask = 0xFF << ((8 - ((dstBit + w) & 7)) & 7);
+
+  uint16_t k = 0;
+  while (k < n) {
+    int16_t i = base + k;
+
+    // Middle: 4 dst bytes from a 5-byte source window
+    if (k > 0 && k + 4 < n && i + 4 < srcBytes) {
+      uint32_t s = (__builtin_bswap32(loadWord(src + i)) << sh) | (src[i + 4] >> (8 - sh));
+      storeWord(dst + k, blendWord<Op>(loadWord(dst + k), __builtin_bswap32(s)));
+      k += 4;
+      continue;
+    }
+
+    uint8_t hi = (i >= 0 && i < srcBytes) ? src[i] : 0;
+    uint8_t lo = (i + 1 < srcBytes) ? src[i + 1] : 0;
+    uint8_t s = (uint8_t)((hi << sh) | (lo >> (8 - sh)));
+    uint8_t m = 0xFF;
+    if (k == 0) m &= 0xFF >> dstBit;
+    if (k == n - 1) m &= lastMask;
+    dst[k] = blendMasked<Op>(dst[k], s, m);
+    k++;
+  }
+}
+
+// Bits [x0, x1) of a row = themselves op black (fill, clear, invert)
+template <uint8_t Op>
+inline void blendSpanT(uint8_t* row, int16_t x0, int16_t x1) {
+  int16_t b0 = x0 >> 3;
+  int16_t b1 = (x1 - 1) >> 3;
+  uint8_t leftMask = 0xFF >> (x0 & 7);
+  uint8_t rightMask = 0xFF << (7 - ((x1 - 1) & 7));
+
+  if (b0 == b1) {
+    row[b0] = blendMasked<Op>(row[b0], 0xFF, leftMask & rightMask);
+    return;
+  }
+  row[b0] = blendMasked<Op>(row[b0], 0xFF, leftMask);
+  row[b1] = blendMasked<Op>(row[b1], 0xFF, rightMask);
+
+  uint8_t* p = row + b0 + 1;
+  uint8_t* end = row + b1;
+  while (p < end && ((uintptr_t)p & 3)) {
+    *p = (uint8_t)blendWord<Op>(*p, 0xFF);
+    p++;
+  }
+  while (p + 4 <= end) {
+    *(uint32_t*)p = blendWord<Op>(*(uint32_t*)p, 0xFFFFFFFFu);
+    p += 4;
+  }
+  while (p < end) {
+    *p = (uint8_t)blendWord<Op>(*p, 0xFF);
+    p++;
+  }
+}
+
+// Runtime op dispatch: one switch per call, not per word
+#define BLEND_SWITCH(op, CALL)                    \
+  switch (op) {                                   \
+    case BLEND_OR:    CALL(BLEND_OR);    break;   \
+    case BLEND_AND:   CALL(BLEND_AND);   break;   \
+    case BLEND_XOR:   CALL(BLEND_XOR);   break;   \
+    case BLEND_CLEAR: CALL(BLEND_CLEAR); break;   \
+    default:          CALL(BLEND_COPY);  break;   \
+  }
+
+inline void blendBytes(uint8_t* dst, const uint8_t* src, size_t n, uint8_t op) {
+#define BLEND_CALL(O) blendBytesT<O>(dst, src, n)
+  BLEND_SWITCH(op, BLEND_CALL)
+#undef BLEND_CALL
+}
+
+inline void blendBits(uint8_t* dst, uint8_t dstBit, const uint8_t* src, uint8_t srcBit,
+                      uint16_t w, uint8_t op) {
+#define BLEND_CALL(O) blendBitsT<O>(dst, dstBit, src, srcBit, w)
+  BLEND_SWITCH(op, BLEND_CALL)
+#undef BLEND_CALL
+}
+
+inline void blendSpan(uint8_t* row, int16_t x0, int16_t x1, uint8_t op) {
+#define BLEND_CALL(O) blendSpanT<O>(row, x0, x1)
+  BLEND_SWITCH(op, BLEND_CALL)
+#undef BLEND_CALL
+}
+
+#endif // BLEND_OPS_H
@@ -0,0 +1,426 @@
+/*
+ * CurveReducer.h
+ * Single-pass curve reduction for thermal printer graphs
+ * Streams raw samples one at a time through max-pool bucketing (one
+ * bucket per graph row) and a centered moving average kept as a running
+ * sum over a small ring, so a 4800-point curve needs no sample or row
+ * buffers - only the few bytes of state below.
+ * REDUCE_ENVELOPE keeps each row's min..max instead (noise stays visible)
+ * and REDUCE_LTTB picks one real sample per row; both skip the smoothing.
+ * Curves with fewer samples than rows (2x density pages) are sampled at
+ * fractional positions between neighbouring samples instead, streamed
+ * with the same constant state.
+ * LiveCurveReducer max-pools and smooths samples pushed as they arrive.
+ * All integer math: samples are int16 in 1/SAMPLE_SCALE pressure units,
+ * so results are bit-identical on FPU (S3) and non-FPU (C3) targets.
+ */
+
+#ifndef CURVE_REDUCER_H
+#define CURVE_REDUCER_H
+
+#include <Arduino.h>
+#include "JobArena.h"
+
+// Moving average window (graph rows, odd)
+#define CURVE_SMOOTH_WINDOW 11
+
+// Sample units per pressure unit (int16 sample 1234 = 12.34)
+#define SAMPLE_SCALE 100
+
+// Candidate samples kept per row bucket by REDUCE_LTTB (larger buckets
+// are thinned to every n-th sample; the bucket average uses them all)
+#define CURVE_LTTB_CANDIDATES 128
+
+// How the samples of one graph row are reduced
+enum CurveReduction {
+  REDUCE_MAX = 0,         // Bucket maximum, then moving average (default)
+  REDUCE_ENVELOPE,        // Bucket min..max, drawn as one filled span per row
+  REDUCE_LTTB             // Largest-Triangle-Three-Buckets: one real sample per row
+};
+
+// Raw samples, read front to back. rewind() restarts the same sequence.
+class SampleSource {
+public:
+  virtual ~SampleSource() {}
+  virtual uint32_t length() const = 0;
+  virtual void rewind() = 0;
+  virtual int16_t next() = 0;
+
+  // Sources with a min / max index (see SampleIndex.h) answer bucket
+  // queries without streaming the samples
+  virtual bool isIndexed() const { return false; }
+  virtual void rangeMinMax(uint32_t from, uint32_t to, int16_t& lo, int16_t& hi) {
+    lo = hi = 0;
+  }
+};
+
+// Samples already in memory (e.g. a controller frame buffer); not copied.
+// stride > 1 reads one channel of interleaved multi-channel samples.
+class BufferSource : public SampleSource {
+private:
+  const int16_t* data;
+  const int16_t* cursor;
+  uint32_t len;
+  uint32_t pos;
+  uint8_t stride;
+
+public:
+  BufferSource(const int16_t* samples = nullptr, uint32_t count = 0, uint8_t step = 1)
+    : data(samples), cursor(samples), len(samples ? count : 0), pos(0),
+      stride(step ? step : 1) {}
+
+  uint32_t length() const { return len; }
+  void rewind() {
+    cursor = data;
+    pos = 0;
+  }
+  int16_t next() {
+    if (pos >= len) return 0;
+    int16_t v = *cursor;
+    cursor += stride;
+    pos++;
+    return v;
+  }
+};
+
+class CurveReducer {
+private:
+  SampleSource* source;
+  uint32_t srcLen;
+  uint32_t srcPos;
+  uint16_t outLen;        // Output rows
+  uint8_t mode;           // CurveReduction
+  bool indexed;           // Buckets come from source->rangeMinMax()
+
+  // Buckets [tail, head) of the moving average window
+  int16_t ring[CURVE_SMOOTH_WINDOW];
+  int32_t sum;
+  uint16_t head;
+  uint16_t tail;
+  uint16_t emitted;       // Smoothed rows produced so far
+
+  // REDUCE_LTTB: candidates of two consecutive row buckets (from the job
+  // arena on first use, else the heap) and the last sample picked
+  struct LttbBucket {
+    uint32_t first;       // Sample index of candidate 0
+    uint32_t step;        // Samples between candidates
+    uint32_t samples;     // Samples in the bucket
+    int32_t sum;
+    uint16_t count;       // Candidates
+  };
+  int16_t* candidates;
+  bool candidatesOwned;   // candidates was malloc'd here (no arena room)
+  JobArena* arena;
+  LttbBucket lttb[2];
+  uint16_t lttbLoaded;    // Buckets read so far
+  uint32_t pickedAt;
+  int16_t picked;
+
+  // Fewer samples than rows: samples [lerpAt, lerpAt + 1] around the row
+  int16_t lerpA;
+  int16_t lerpB;
+  uint32_t lerpAt;
+
+  // Not copyable (owns the candidate buffer)
+  CurveReducer(const CurveReducer&);
+  CurveReducer& operator=(const CurveReducer&);
+
+  // Sample range of row bucket i: [i * srcLen / outLen, (i + 1) * srcLen / outLen)
+  uint32_t bucketEnd(uint16_t i) const {
+    return (uint32_t)(((uint64_t)(i + 1) * srcLen) / outLen);
+  }
+
+  // Row i of a curve with srcLen <= outLen samples. Row centres map to
+  // sample positions t = (i + 0.5) * srcLen / outLen - 0.5 (Q16), so the
+  // samples spread evenly over all rows; the value is interpolated
+  // between the two samples around t.
+  int16_t upsample(uint16_t i) {
+    int64_t num = (int64_t)(2 * i + 1) * srcLen - outLen;
+    int64_t t = num > 0 ? (num << 16) / (2 * (int64_t)outLen) : 0;
+    uint32_t at = (uint32_t)(t >> 16);
+    int32_t frac = (int32_t)(t & 0xFFFF);
+
+    if (srcPos == 0) {
+      lerpA = source->next();
+      lerpB = srcLen > 1 ? source->next() : lerpA;
+      srcPos = min(srcLen, (uint32_t)2);
+      lerpAt = 0;
+    }
+    while (lerpAt < at) {
+      lerpA = lerpB;
+      if (srcPos < srcLen) {
+        lerpB = source->next();
+        srcPos++;
+      }
+      lerpAt++;
+    }
+    if (lerpAt + 1 >= srcLen) return lerpA;
+    return lerpA + (int16_t)((((int64_t)(lerpB - lerpA) * frac) + 0x8000) >> 16);
+  }
+
+  // Min and max of the samples falling into row bucket i
+  void bucket(uint16_t i, int16_t& lo, int16_t& hi) {
+    if (srcLen <= outLen) {
+      lo = hi = upsample(i);
+      return;
+    }
+
+    uint32_t end = bucketEnd(i);
+    if (indexed) {
+      source->rangeMinMax(srcPos, end, lo, hi);
+      srcPos = end;
+      return;
+    }
+
+    lo = INT16_MAX;
+    hi = INT16_MIN;
+    while (srcPos < end) {
+      int16_t v = source->next();
+      srcPos++;
+      if (v > hi) hi = v;
+      if (v < lo) lo = v;
+    }
+  }
+
+  // Read row bucket i into LTTB slot i % 2
+  void loadLttb(uint16_t i) {
+    LttbBucket& b = lttb[i & 1];
+    int16_t* cand = candidates + (i & 1) * CURVE_LTTB_CANDIDATES;
+    uint32_t end = bucketEnd(i);
+
+    b.first = srcPos;
+    b.samples = end - srcPos;
+    b.step = (b.samples + CURVE_LTTB_CANDIDATES - 1) / CURVE_LTTB_CANDIDATES;
+    b.sum = 0;
+    b.count = 0;
+
+    uint32_t skip = 0;
+    while (srcPos < end) {
+      int16_t v = source->next();
+      srcPos++;
+      b.sum += v;
+      if (skip == 0) {
+        cand[b.count++] = v;
+        skip = b.step;
+      }
+      skip--;
+    }
+    lttbLoaded = i + 1;
+
+    // The path starts at the first sample
+    if (i == 0 && b.count) picked = cand[0];
+  }
+
+  // Candidate of bucket i with the largest triangle between the last pick
+  // and the average of bucket i + 1 (integer area, scaled by 2 * count)
+  int16_t pickLttb(uint16_t i) {
+    while (lttbLoaded <= i + 1 && lttbLoaded < outLen) loadLttb(lttbLoaded);
+
+    const LttbBucket& b = lttb[i & 1];
+    const int16_t* cand = candidates + (i & 1) * CURVE_LTTB_CANDIDATES;
+    const LttbBucket& c = i + 1 < outLen ? lttb[(i + 1) & 1] : b;
+
+    // C = (first + (samples - 1) / 2, sum / samples), kept as 2x / n-x sums
+    int64_t n = c.samples;
+    int64_t x = n * (2 * (int64_t)pickedAt - (2 * (int64_t)c.first + c.samples - 1));
+    int64_t y = 2 * ((int64_t)c.sum - n * picked);
+
+    int64_t best = -1;
+    uint16_t bestK = 0;
+    for (uint16_t k = 0; k < b.count; k++) {
+      int64_t t = b.first + (uint32_t)k * b.step;
+      int64_t area = x * (cand[k] - picked) - ((int64_t)pickedAt - t) * y;
+      if (area < 0) area = -area;
+      if (area > best) {
+        best = area;
+        bestK = k;
+      }
+    }
+
+    pickedAt = b.first + (uint32_t)bestK * b.step;
+    picked = cand[bestK];
+    return picked;
+  }
+
+public:
+  CurveReducer() : source(nullptr), srcLen(0), srcPos(0), outLen(0), mode(REDUCE_MAX),
+                   indexed(false), sum(0), head(0), tail(0), emitted(0),
+                   candidates(nullptr), candidatesOwned(false), arena(nullptr),
+                   lttbLoaded(0), pickedAt(0), picked(0),
+                   lerpA(0), lerpB(0), lerpAt(0) {}
+
+  ~CurveReducer() {
+    if (candidatesOwned) free(candidates);
+  }
+
+  // Job arena for the LTTB candidates (nullptr = heap). Its buffers live
+  // until the arena's reset(), so set it per job.
+  void setArena(JobArena* jobArena) {
+    if (!candidatesOwned) candidates = nullptr;   // Belonged to the old arena
+    arena = jobArena;
+  }
+
+  // Start reducing src to rows outputs (rewinds the source). REDUCE_LTTB
+  // falls back to REDUCE_MAX if its candidate buffer cannot be allocated.
+  void begin(SampleSource& src, uint16_t rows, CurveReduction how = REDUCE_MAX) {
+    source = &src;
+    srcLen = src.length();
+    outLen = rows;
+    srcPos = 0;
+    sum = 0;
+    head = 0;
+    tail = 0;
+    emitted = 0;
+    src.rewind();
+
+    mode = how;
+    if (mode == REDUCE_LTTB && srcLen > outLen && !candidates) {
+      if (arena) candidates = arena->allocArray<int16_t>(2 * CURVE_LTTB_CANDIDATES);
+      if (!candidates) {
+        candidates = (int16_t*)malloc(2 * CURVE_LTTB_CANDIDATES * sizeof(int16_t));
+        candidatesOwned = candidates != nullptr;
+      }
+      if (!candidates) {
+        Serial.println("  ✗ LTTB buffer not allocated, using max-pooling");
+        mode = REDUCE_MAX;
+      }
+    }
+    indexed = mode != REDUCE_LTTB && src.isIndexed();
+    lttbLoaded = 0;
+    pickedAt = 0;
+    picked = 0;
+  }
+
+  // Next row: lo..hi is the row's span (lo == hi except for
+  // REDUCE_ENVELOPE); false once all rows are out
+  bool next(int16_t& lo, int16_t& hi) {
+    if (!source || emitted >= outLen) return false;
+
+    if (mode == REDUCE_ENVELOPE || (mode == REDUCE_LTTB && srcLen <= outLen)) {
+      bucket(emitted++, lo, hi);
+      return true;
+    }
+    if (mode == REDUCE_LTTB) {
+      lo = hi = pickLttb(emitted++);
+      return true;
+    }
+
+    const int16_t half = CURVE_SMOOTH_WINDOW / 2;
+    int16_t i = emitted;
+
+    // Slide the window to rows [i - half, i + half], clipped to the curve
+    while ((int16_t)tail < i - half) {
+      sum -= ring[tail % CURVE_SMOOTH_WINDOW];
+      tail++;
+    }
+    while (head < outLen && (int16_t)head <= i + half) {
+      int16_t bLo, b;
+      bucket(head, bLo, b);
+      if (srcLen > outLen && b < 0) b = 0;    // Pooled maxima start at 0
+      ring[head % CURVE_SMOOTH_WINDOW] = b;
+      sum += b;
+      head++;
+    }
+
+    // Rounded mean (half away from zero)
+    int32_t count = head - tail;
+    lo = hi = (sum >= 0 ? sum + count / 2 : sum - count / 2) / count;
+    emitted++;
+    return true;
+  }
+
+  bool next(int16_t& value) {
+    int16_t lo;
+    return next(lo, value);
+  }
+
+  // Rows produced so far (index of the next row)
+  uint16_t position() const { return emitted; }
+  uint16_t rows() const { return outLen; }
+  CurveReduction reduction() const { return (CurveReduction)mode; }
+};
+
+// Same reduction for an open-ended stream pushed one sample at a time
+// (strip charts): every samplesPerRow samples are max-pooled into one row
+// bucket, and a row is smoothed as soon as the window ahead of it is full.
+// Drain next() after every push().
+class LiveCurveReducer {
+private:
+  // Buckets [tail, head); one spare slot for the bucket ahead of the window
+  int16_t ring[CURVE_SMOOTH_WINDOW + 1];
+  int32_t sum;
+  uint32_t head;
+  uint32_t tail;
+  uint32_t emitted;
+
+  uint16_t perRow;
+  uint16_t pending;       // Samples in the open bucket
+  int16_t bucketMax;
+  bool flushed;           // No more samples: the window may end early
+
+  void pushBucket(int16_t b) {
+    ring[head % (CURVE_SMOOTH_WINDOW + 1)] = b;
+    sum += b;
+    head++;
+  }
+
+public:
+  LiveCurveReducer() { begin(1); }
+
+  void begin(uint16_t samplesPerRow) {
+    perRow = samplesPerRow ? samplesPerRow : 1;
+    sum = 0;
+    head = 0;
+    tail = 0;
+    emitted = 0;
+    pending = 0;
+    bucketMax = 0;
+    flushed = false;
+  }
+
+  void push(int16_t v) {
+    if (flushed) return;
+    if (v > bucketMax) {
+      bucketMax = v;
+    }
+    if (++pending == perRow) {
+      pushBucket(bucketMax);
+      pending = 0;
+      bucketMax = 0;
+    }
+  }
+
+  // End of the stream: close the open bucket, release the last rows
+  void flush() {
+    if (flushed) return;
+    if (pending) {
+      pushBucket(bucketMax);
+      pending = 0;
+    }
+    flushed = true;
+  }
+
+  // Next smoothed row; false until enough samples have arrived
+  bool next(int16_t& value) {
+    const uint32_t half = CURVE_SMOOTH_WINDOW / 2;
+    uint32_t i = emitted;
+    if (i >= head || (!flushed && head <= i + half)) return false;
+
+    // Window [i - half, i + half], clipped to the stream
+    while (tail + half < i) {
+      sum -= ring[tail % (CURVE_SMOOTH_WINDOW + 1)];
+      tail++;
+    }
+
+    // Rounded mean (half away from zero)
+    int32_t count = head - tail;
+    value = (sum >= 0 ? sum + count / 2 : sum - count / 2) / count;
+    emitted++;
+    return true;
+  }
+
+  // Rows produced so far (index of the next row)
+  uint32_t position() const { return emitted; }
+};
+
+#endif // CURVE_REDUCER_H
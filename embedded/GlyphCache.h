@@ -0,0 +1,101 @@
+/*
+ * GlyphCache.h
+ * Pre-rasterised Font5x7 glyphs for fast text blitting
+ * Each (size, rotation) pair is built once on first use: every glyph is
+ * scaled and optionally rotated 90° clockwise into one 32-bit mask per
+ * output row, so drawing text is a shift/OR per row instead of size²
+ * setPixel calls per lit font bit.
+ */
+
+#ifndef GLYPH_CACHE_H
+#define GLYPH_CACHE_H
+
+#include <Arduino.h>
+#include "Font5x7.h"
+
+#define GLYPH_CACHE_MAX_SIZE 4   // Largest scale cached (7 * 4 = 28 px fits a mask)
+#define GLYPH_CACHE_SLOTS    4   // (size, rotation) pairs cached at once
+
+// One pre-rendered glyph set
+struct GlyphSlot {
+  uint8_t size;       // Scale factor (0 = slot unused)
+  bool rotate90;
+  uint8_t rows;       // Output rows per glyph
+  uint8_t cols;       // Output width in pixels
+  uint32_t* bits;     // FONT5X7_GLYPHS * rows masks, bit 31 = leftmost pixel
+};
+
+class GlyphCache {
+private:
+  static GlyphSlot* slots() {
+    static GlyphSlot table[GLYPH_CACHE_SLOTS] = {};
+    return table;
+  }
+
+  // Rasterise all glyphs for one (size, rotation) pair
+  static bool build(GlyphSlot& slot, uint8_t size, bool rotate90) {
+    uint8_t rows = (rotate90 ? 5 : 7) * size;
+    uint8_t cols = (rotate90 ? 7 : 5) * size;
+
+    uint32_t* bits = (uint32_t*)calloc(FONT5X7_GLYPHS * rows, sizeof(uint32_t));
+    if (!bits) return false;
+
+    for (uint8_t g = 0; g < FONT5X7_GLYPHS; g++) {
+      uint32_t* glyphRows = bits + g * rows;
+
+      for (uint8_t row = 0; row < 7; row++) {
+        uint8_t line = font5x7_data[g][row];
+
+        for (uint8_t col = 0; col < 5; col++) {
+          if (!(line & (0x80 >> col))) continue;
+
+          // Same placement as BitmapCanvas::drawChar
+          uint8_t px = rotate90 ? (6 - row) * size : col * size;
+          uint8_t py = rotate90 ? col * size : row * size;
+          uint32_t block = ((uint32_t)0xFFFFFFFF << (32 - size)) >> px;
+
+          for (uint8_t sy = 0; sy < size; sy++) {
+            glyphRows[py + sy] |= block;
+          }
+        }
+      }
+    }
+
+    slot.rows = rows;
+    slot.cols = cols;
+    slot.rotate90 = rotate90;
+    slot.bits = bits;
+    slot.size = size;  // Published last: slot is now usable
+    return true;
+  }
+
+public:
+  // Glyph set for (size, rotation), built on first use.
+  // Returns nullptr if the size is not cacheable or memory ran out.
+  static const GlyphSlot* get(uint8_t size, bool rotate90) {
+    if (size == 0 || size > GLYPH_CACHE_MAX_SIZE) return nullptr;
+
+    GlyphSlot* table = slots();
+    for (uint8_t i = 0; i < GLYPH_CACHE_SLOTS; i++) {
+      if (table[i].size == size && table[i].rotate90 == rotate90) {
+        return &table[i];
+      }
+    }
+
+    for (uint8_t i = 0; i < GLYPH_CACHE_SLOTS; i++) {
+      if (table[i].size == 0) {
+        return build(table[i], size, rotate90) ? &table[i] : nullptr;
+      }
+    }
+
+    return nullptr;
+  }
+
+  // Build a glyph set ahead of time (e.g. in setup(), before render
+  // tasks start) so no task pays for it mid-job
+  static bool warm(uint8_t size, bool rotate90) {
+    return get(size, rotate90) != nullptr;
+  }
+};
+
+#endif // GLYPH_CACHE_H
@@ -0,0 +1,122 @@
+/*
+ * JobArena.h
+ * Memory placement and job-scoped allocation for thermal printer jobs
+ * Large buffers that are read rarely (background layer, sample frames,
+ * recorded job streams) go to PSRAM when the board has it, so internal
+ * RAM stays free for the hot band buffers. Buffers that live for one job
+ * come from a JobArena: one block allocated at startup, bumped per
+ * allocation and reset in O(1) when the job ends, so long-running units
+ * never fragment the heap with per-job malloc / free.
+ */
+
+#ifndef JOB_ARENA_H
+#define JOB_ARENA_H
+
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+
+enum MemoryRegion {
+  REGION_INTERNAL = 0,    // Internal DRAM: band buffers, rows touched per band
+  REGION_PSRAM            // PSRAM if present, else internal DRAM
+};
+
+// Capability flags of a region's first choice
+inline uint32_t regionCaps(MemoryRegion region) {
+  return region == REGION_PSRAM ? (MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
+                                : (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+}
+
+// malloc() / realloc() in a region; PSRAM falls back to internal RAM
+inline void* regionMalloc(size_t bytes, MemoryRegion region) {
+  void* p = heap_caps_malloc(bytes, regionCaps(region));
+  if (!p && region == REGION_PSRAM) {
+    p = heap_caps_malloc(bytes, regionCaps(REGION_INTERNAL));
+  }
+  return p;
+}
+
+inline void* regionRealloc(void* ptr, size_t bytes, MemoryRegion region) {
+  void* p = heap_caps_realloc(ptr, bytes, regionCaps(region));
+  if (!p && region == REGION_PSRAM) {
+    p = heap_caps_realloc(ptr, bytes, regionCaps(REGION_INTERNAL));
+  }
+  return p;
+}
+
+inline void regionFree(void* ptr) {
+  heap_caps_free(ptr);
+}
+
+class JobArena {
+private:
+  uint8_t* base;
+  size_t capacity;
+  size_t used;
+  size_t peak;            // Most bytes in use during one job
+  uint32_t failures;      // Requests that did not fit
+  bool psram;             // Block landed in PSRAM
+
+  // Not copyable (owns its block)
+  JobArena(const JobArena&);
+  JobArena& operator=(const JobArena&);
+
+public:
+  JobArena() : base(nullptr), capacity(0), used(0), peak(0), failures(0),
+               psram(false) {}
+
+  ~JobArena() {
+    regionFree(base);
+  }
+
+  // Allocate the block once (usually in setup)
+  bool begin(size_t bytes, MemoryRegion where) {
+    regionFree(base);
+    base = (uint8_t*)heap_caps_malloc(bytes, regionCaps(where));
+    psram = base && where == REGION_PSRAM;
+    if (!base && where == REGION_PSRAM) {
+      base = (uint8_t*)heap_caps_malloc(bytes, regionCaps(REGION_INTERNAL));
+    }
+    capacity = base ? bytes : 0;
+    used = 0;
+    return base != nullptr;
+  }
+
+  // 4-byte aligned block, valid until reset(); nullptr if it does not fit
+  // (callers fall back to the heap)
+  void* alloc(size_t bytes) {
+    size_t start = (used + 3) & ~(size_t)3;
+    if (!base || start + bytes > capacity) {
+      failures++;
+      return nullptr;
+    }
+    used = start + bytes;
+    if (used > peak) peak = used;
+    return base + start;
+  }
+
+  template <class T>
+  T* allocArray(size_t count) {
+    return (T*)alloc(count * sizeof(T));
+  }
+
+  // End of job: everything allocated since the last reset is released
+  void reset() {
+    used = 0;
+  }
+
+  void print(const char* name) const {
+    Serial.printf("  %s arena: %lu / %lu bytes peak, %lu misses (%s)\n", name,
+                  (unsigned long)peak, (unsigned long)capacity, (unsigned long)failures,
+                  psram ? "PSRAM" : "internal");
+  }
+
+  // Getters
+  bool isValid() const { return base != nullptr; }
+  bool isPsram() const { return psram; }
+  size_t getCapacity() const { return capacity; }
+  size_t getUsed() const { return used; }
+  size_t getPeak() const { return peak; }
+  uint32_t getFailures() const { return failures; }
+};
+
+#endif // JOB_ARENA_H
@@ -0,0 +1,281 @@
+/*
+ * JobLog.h
+ * Append-only log of printed jobs and their samples on a flash partition
+ * Every record starts on a flash sector: a 64-byte header (job number,
+ * sample count, channels, description, CRCs) followed by the raw int16
+ * samples. The log wraps around, erasing the oldest records as it goes.
+ * A RAM index of the newest JOB_LOG_INDEX records is rebuilt at boot from
+ * one header read per record. Reprints map a record with
+ * esp_partition_mmap() and render the samples straight from flash.
+ *
+ * The partition is a raw data partition, e.g. in partitions.csv:
+ *   joblog, data, 0x40, , 1M
+ * (or point JOB_LOG_PARTITION at the default table's unused "spiffs").
+ */
+
+#ifndef JOB_LOG_H
+#define JOB_LOG_H
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include "SampleFrame.h"
+
+// Partition label of the log
+#ifndef JOB_LOG_PARTITION
+#define JOB_LOG_PARTITION "joblog"
+#endif
+
+// Records kept in the RAM index (older ones stay on flash until erased)
+#define JOB_LOG_INDEX 64
+
+// Flash erase unit; records are aligned to it
+#define JOB_LOG_SECTOR 4096
+
+#define JOB_LOG_MAGIC     0x474F4C4Au   // "JLOG"
+#define JOB_LOG_COMMITTED 0x00000000u   // Written last: 1 -> 0 bits only
+
+// On-flash record header (samples follow)
+struct JobLogHeader {
+  uint32_t magic;
+  uint32_t seq;           // Job number, counts up across reboots
+  uint32_t count;         // Samples (all channels)
+  uint32_t crc;           // CRC32 of the samples
+  uint16_t sectors;       // Flash sectors of the whole record
+  uint8_t channels;
+  uint8_t reduction;      // CurveReduction the job was printed with
+  uint32_t reserved;
+  char description[32];
+  uint32_t headerCrc;     // CRC32 of the fields above
+  uint32_t committed;     // JOB_LOG_COMMITTED once the samples are written
+};
+
+static_assert(sizeof(JobLogHeader) == 64, "Samples must follow the header 4-byte aligned");
+
+// RAM index entry
+struct JobLogEntry {
+  uint32_t seq;
+  uint32_t count;
+  uint16_t sector;        // First sector of the record
+  uint16_t sectors;
+  uint8_t channels;
+  uint8_t reduction;
+};
+
+// A logged job mapped into the data address space. Samples are read
+// from flash through the cache; nothing is copied to RAM.
+class MappedJob {
+private:
+  spi_flash_mmap_handle_t handle;
+  const JobLogHeader* header;
+
+  // Not copyable (owns the mapping)
+  MappedJob(const MappedJob&);
+  MappedJob& operator=(const MappedJob&);
+
+  friend class JobLog;
+
+public:
+  MappedJob() : handle(0), header(nullptr) {}
+
+  ~MappedJob() {
+    unmap();
+  }
+
+  void unmap() {
+    if (header) spi_flash_munmap(handle);
+    header = nullptr;
+  }
+
+  bool isValid() const { return header != nullptr; }
+  const int16_t* samples() const { return (const int16_t*)(header + 1); }
+  uint32_t count() const { return header->count; }
+  uint8_t channels() const { return header->channels; }
+  uint8_t reduction() const { return header->reduction; }
+  uint32_t seq() const { return header->seq; }
+  const char* description() const { return header->description; }
+};
+
+// Callers sharing a log between tasks serialise append() and map() /
+// unmap() themselves: an append may erase a mapped record.
+class JobLog {
+private:
+  const esp_partition_t* part;
+  uint16_t sectorCount;
+  uint16_t head;                        // Sector the next record starts on
+  uint32_t nextSeq;
+  JobLogEntry entries[JOB_LOG_INDEX];   // Oldest first
+  uint8_t count;
+
+  static uint32_t recordSectors(uint32_t samples) {
+    return (sizeof(JobLogHeader) + samples * sizeof(int16_t) + JOB_LOG_SECTOR - 1) / JOB_LOG_SECTOR;
+  }
+
+  static uint32_t headerCrc(const JobLogHeader& h) {
+    return SampleFrameReader::crc32(0, (const uint8_t*)&h, offsetof(JobLogHeader, headerCrc));
+  }
+
+  // Committed, self-consistent record header at a sector
+  bool readHeader(uint16_t sector, JobLogHeader& h) const {
+    if (esp_partition_read(part, (size_t)sector * JOB_LOG_SECTOR, &h, sizeof(h)) != ESP_OK) {
+      return false;
+    }
+    return h.magic == JOB_LOG_MAGIC && h.committed == JOB_LOG_COMMITTED &&
+           h.headerCrc == headerCrc(h) && h.sectors == recordSectors(h.count) &&
+           (uint32_t)sector + h.sectors <= sectorCount;
+  }
+
+  // Add to the index in job order; the oldest entry goes when it is full
+  void insert(const JobLogEntry& e) {
+    if (count == JOB_LOG_INDEX) {
+      if (e.seq < entries[0].seq) return;
+      memmove(entries, entries + 1, (JOB_LOG_INDEX - 1) * sizeof(JobLogEntry));
+      count--;
+    }
+    uint8_t i = count;
+    while (i > 0 && entries[i - 1].seq > e.seq) {
+      entries[i] = entries[i - 1];
+      i--;
+    }
+    entries[i] = e;
+    count++;
+  }
+
+  // Drop the entries of records touching sectors [from, from + n)
+  void forget(uint16_t from, uint16_t n) {
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < count; i++) {
+      const JobLogEntry& e = entries[i];
+      if (e.sector + e.sectors <= from || e.sector >= from + n) {
+        entries[kept++] = e;
+      }
+    }
+    count = kept;
+  }
+
+  const JobLogEntry* find(uint32_t seq) const {
+    if (count == 0) return nullptr;
+    if (seq == 0) return &entries[count - 1];
+    for (uint8_t i = 0; i < count; i++) {
+      if (entries[i].seq == seq) return &entries[i];
+    }
+    return nullptr;
+  }
+
+  // Not copyable (one writer per partition)
+  JobLog(const JobLog&);
+  JobLog& operator=(const JobLog&);
+
+public:
+  JobLog() : part(nullptr), sectorCount(0), head(0), nextSeq(1), count(0) {}
+
+  // Find the partition and rebuild the index (one header read per record)
+  bool begin(const char* label = JOB_LOG_PARTITION) {
+    part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+    count = 0;
+    head = 0;
+    nextSeq = 1;
+    if (!part) return false;
+
+    sectorCount = min(part->size / JOB_LOG_SECTOR, (uint32_t)UINT16_MAX);
+    uint32_t newest = 0;
+    uint16_t s = 0;
+    while (s < sectorCount) {
+      JobLogHeader h;
+      if (!readHeader(s, h)) {
+        s++;
+        continue;
+      }
+
+      JobLogEntry e = {h.seq, h.count, s, h.sectors, h.channels, h.reduction};
+      insert(e);
+      if (h.seq >= newest) {
+        newest = h.seq;
+        head = s + h.sectors;
+      }
+      s += h.sectors;
+    }
+    if (head >= sectorCount) head = 0;
+    nextSeq = newest + 1;
+    return true;
+  }
+
+  // Append a job; returns its number (0 = not logged). Erases the oldest
+  // records in the way: a few ms per 4 KB sector, flash cache stalled.
+  uint32_t append(const int16_t* samples, uint32_t n, uint8_t channels, uint8_t reduction,
+                  const char* description) {
+    if (!part || !samples || n == 0) return 0;
+    uint32_t sectors = recordSectors(n);
+    if (sectors > sectorCount) return 0;
+    if (head + sectors > sectorCount) head = 0;      // Records never wrap
+
+    forget(head, sectors);
+    size_t offset = (size_t)head * JOB_LOG_SECTOR;
+    if (esp_partition_erase_range(part, offset, sectors * JOB_LOG_SECTOR) != ESP_OK) return 0;
+
+    JobLogHeader h;
+    memset(&h, 0, sizeof(h));
+    h.magic = JOB_LOG_MAGIC;
+    h.seq = nextSeq;
+    h.count = n;
+    h.crc = SampleFrameReader::crc32(0, (const uint8_t*)samples, n * sizeof(int16_t));
+    h.sectors = sectors;
+    h.channels = channels;
+    h.reduction = reduction;
+    strncpy(h.description, description, sizeof(h.description) - 1);
+    h.headerCrc = headerCrc(h);
+    h.committed = 0xFFFFFFFF;   // Left erased until the samples are in
+
+    uint32_t committed = JOB_LOG_COMMITTED;
+    if (esp_partition_write(part, offset, &h, sizeof(h)) != ESP_OK ||
+        esp_partition_write(part, offset + sizeof(h), samples, n * sizeof(int16_t)) != ESP_OK ||
+        esp_partition_write(part, offset + offsetof(JobLogHeader, committed),
+                            &committed, sizeof(committed)) != ESP_OK) {
+      return 0;
+    }
+
+    JobLogEntry e = {nextSeq, n, head, (uint16_t)sectors, channels, reduction};
+    insert(e);
+    head += sectors;
+    if (head >= sectorCount) head = 0;
+    return nextSeq++;
+  }
+
+  // Map job seq (0 = newest) and check its samples' CRC
+  bool map(uint32_t seq, MappedJob& job) const {
+    job.unmap();
+    const JobLogEntry* e = find(seq);
+    if (!e) return false;
+
+    const void* ptr = nullptr;
+    if (esp_partition_mmap(part, (size_t)e->sector * JOB_LOG_SECTOR, (size_t)e->sectors * JOB_LOG_SECTOR,
+                           SPI_FLASH_MMAP_DATA, &ptr, &job.handle) != ESP_OK) {
+      return false;
+    }
+    job.header = (const JobLogHeader*)ptr;
+
+    const JobLogHeader& h = *job.header;
+    if (h.magic != JOB_LOG_MAGIC || h.seq != e->seq ||
+        SampleFrameReader::crc32(0, (const uint8_t*)job.samples(), h.count * sizeof(int16_t)) != h.crc) {
+      job.unmap();
+      return false;
+    }
+    return true;
+  }
+
+  // Newest first: number, points, channels, description
+  void print() const {
+    for (uint8_t i = count; i-- > 0;) {
+      JobLogHeader h;
+      const char* what = readHeader(entries[i].sector, h) ? h.description : "?";
+      Serial.printf("  #%-5lu %6lu pt  %d ch  %s\n", (unsigned long)entries[i].seq,
+                    (unsigned long)entries[i].count, entries[i].channels, what);
+    }
+    if (count == 0) Serial.println("  (empty)");
+  }
+
+  bool isReady() const { return part != nullptr; }
+  uint8_t getCount() const { return count; }
+  uint32_t capacityBytes() const { return (uint32_t)sectorCount * JOB_LOG_SECTOR; }
+};
+
+#endif // JOB_LOG_H
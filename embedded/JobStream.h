@@ -0,0 +1,176 @@
+/*
+ * JobStream.h
+ * Recorded ESC/POS job streams for thermal printer reprints
+ * While a recorder is attached, ThermalPrinter appends every byte it sends
+ * (commands, text and raster data) to a JobStream, so a finished job is one
+ * contiguous byte stream. Replaying it with ThermalPrinter::printStream()
+ * costs only wire time: nothing is rendered again.
+ */
+
+#ifndef JOB_STREAM_H
+#define JOB_STREAM_H
+
+#include <Arduino.h>
+#include "JobArena.h"
+
+// Stream buffer growth
+#define JOB_STREAM_INITIAL 4096     // First allocation (bytes)
+#define JOB_STREAM_MAX     131072   // Larger jobs are not recorded
+
+// Recorded jobs kept for reprint
+#define JOB_CACHE_SLOTS 3
+
+class JobStream {
+private:
+  uint8_t* data;          // Grows by doubling, in PSRAM when present
+  size_t length;
+  size_t capacity;
+  bool overflowed;        // Bytes were dropped: stream is incomplete
+
+  bool reserve(size_t needed) {
+    if (needed <= capacity) return true;
+    if (needed > JOB_STREAM_MAX) return false;
+
+    size_t newCapacity = capacity ? capacity : JOB_STREAM_INITIAL;
+    while (newCapacity < needed) {
+      newCapacity *= 2;
+    }
+    if (newCapacity > JOB_STREAM_MAX) newCapacity = JOB_STREAM_MAX;
+
+    uint8_t* grown = (uint8_t*)regionRealloc(data, newCapacity, REGION_PSRAM);
+    if (!grown) return false;
+
+    data = grown;
+    capacity = newCapacity;
+    return true;
+  }
+
+  // Not copyable (owns its buffer)
+  JobStream(const JobStream&);
+  JobStream& operator=(const JobStream&);
+
+public:
+  JobStream() : data(nullptr), length(0), capacity(0), overflowed(false) {}
+
+  ~JobStream() {
+    regionFree(data);
+  }
+
+  // Start a new recording (keeps the buffer for reuse)
+  void reset() {
+    length = 0;
+    overflowed = false;
+  }
+
+  // Append sent bytes. Once a write does not fit, the stream is marked
+  // incomplete and ignores further bytes.
+  void append(const uint8_t* buf, size_t len) {
+    if (overflowed || len == 0) return;
+
+    if (!reserve(length + len)) {
+      overflowed = true;
+      return;
+    }
+    memcpy(data + length, buf, len);
+    length += len;
+  }
+
+  // Stream holds a whole job
+  bool isComplete() const { return !overflowed && length > 0; }
+
+  // Getters
+  const uint8_t* getData() const { return data; }
+  size_t getSize() const { return length; }
+};
+
+// The last JOB_CACHE_SLOTS recorded jobs, newest first. Several jobs may
+// be recorded at once (one per printer); callers sharing a cache between
+// tasks serialise begin() / commit() / discard() / get() themselves.
+class JobStreamCache {
+private:
+  JobStream streams[JOB_CACHE_SLOTS];
+  uint32_t order[JOB_CACHE_SLOTS];      // Commit sequence number (0 = empty)
+  bool recording[JOB_CACHE_SLOTS];
+  uint32_t lastOrder;
+
+  int8_t slotOf(const JobStream* stream) const {
+    for (uint8_t i = 0; i < JOB_CACHE_SLOTS; i++) {
+      if (stream == &streams[i]) return i;
+    }
+    return -1;
+  }
+
+public:
+  JobStreamCache() : lastOrder(0) {
+    for (uint8_t i = 0; i < JOB_CACHE_SLOTS; i++) {
+      order[i] = 0;
+      recording[i] = false;
+    }
+  }
+
+  // Stream to record the next job into: an empty slot, else the oldest
+  // job is overwritten. nullptr if every slot is being recorded.
+  JobStream* begin() {
+    int8_t slot = -1;
+    for (uint8_t i = 0; i < JOB_CACHE_SLOTS; i++) {
+      if (!recording[i] && (slot < 0 || order[i] < order[slot])) {
+        slot = i;
+      }
+    }
+    if (slot < 0) return nullptr;
+
+    streams[slot].reset();
+    order[slot] = 0;
+    recording[slot] = true;
+    return &streams[slot];
+  }
+
+  // Keep a job recorded since begin(); false if it was incomplete
+  bool commit(JobStream* stream) {
+    int8_t slot = slotOf(stream);
+    if (slot < 0 || !recording[slot]) return false;
+    recording[slot] = false;
+
+    if (!streams[slot].isComplete()) {
+      streams[slot].reset();
+      return false;
+    }
+    order[slot] = ++lastOrder;
+    return true;
+  }
+
+  // Drop a job recorded since begin() (e.g. after a failed print)
+  void discard(JobStream* stream) {
+    int8_t slot = slotOf(stream);
+    if (slot < 0 || !recording[slot]) return;
+    recording[slot] = false;
+    streams[slot].reset();
+  }
+
+  // age 0 = last job, 1 = the one before, ...; nullptr if not stored
+  const JobStream* get(uint8_t age = 0) const {
+    uint32_t below = 0xFFFFFFFF;
+    int8_t slot = -1;
+    for (uint8_t n = 0; n <= age; n++) {
+      slot = -1;
+      for (uint8_t i = 0; i < JOB_CACHE_SLOTS; i++) {
+        if (order[i] && order[i] < below && (slot < 0 || order[i] > order[slot])) {
+          slot = i;
+        }
+      }
+      if (slot < 0) return nullptr;
+      below = order[slot];
+    }
+    return &streams[slot];
+  }
+
+  uint8_t getCount() const {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < JOB_CACHE_SLOTS; i++) {
+      if (order[i]) count++;
+    }
+    return count;
+  }
+};
+
+#endif // JOB_STREAM_H
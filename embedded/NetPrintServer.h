@@ -0,0 +1,358 @@
+/*
+ * NetPrintServer.h
+ * Wi-Fi job entry points for the thermal printer
+ * RawPrintServer is a port-9100 ("JetDirect") ESC/POS passthrough: bytes
+ * received from one client at a time are read straight into a ByteRing
+ * and drained to the printer UART by the print task, so a job of any
+ * size needs only the ring. SampleHttpServer takes sample frames (the
+ * SampleFrame.h format) as the body of POST /samples and hands the
+ * connection to a hook that reads them into a sample buffer.
+ *
+ * Back-pressure: a full ring stops the raw server reading, so TCP closes
+ * the sender's window; further raw clients wait in the listen backlog.
+ * The sample hook answers 503 + Retry-After when no buffer or queue slot
+ * frees up in time.
+ */
+
+#ifndef NET_PRINT_SERVER_H
+#define NET_PRINT_SERVER_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include "JobArena.h"
+
+#define NET_RAW_PORT  9100
+#define NET_HTTP_PORT 80
+
+#define NET_RING_BYTES      8192    // Raw passthrough ring (internal RAM)
+#define NET_IDLE_TIMEOUT_MS 10000   // Raw session ends after this much silence
+#define NET_HTTP_TIMEOUT_MS 2000    // Max silence inside a request
+#define NET_TASK_STACK      4096
+#define NET_TASK_CORE       0       // With the Wi-Fi stack
+
+// Single-producer / single-consumer byte ring. Both sides work in place
+// on contiguous spans: the network reads into the ring and the printer
+// writes out of it, with no staging copy.
+class ByteRing {
+private:
+  uint8_t* data;
+  size_t size;
+  size_t head;                  // Bytes written, ever (index = head % size)
+  size_t tail;                  // Bytes read, ever
+  bool closed;                  // Producer is done: drain, then end
+  bool aborted;                 // Consumer gave up: producer drops the rest
+  portMUX_TYPE lock;
+  SemaphoreHandle_t dataReady;  // Given when bytes arrive or the ring ends
+  SemaphoreHandle_t spaceReady; // Given when bytes are consumed or aborted
+
+  // Not copyable (owns its buffer and semaphores)
+  ByteRing(const ByteRing&);
+  ByteRing& operator=(const ByteRing&);
+
+public:
+  ByteRing() : data(nullptr), size(0), head(0), tail(0), closed(false), aborted(false),
+               dataReady(nullptr), spaceReady(nullptr) {
+    portMUX_INITIALIZE(&lock);
+  }
+
+  ~ByteRing() {
+    regionFree(data);
+    if (dataReady) vSemaphoreDelete(dataReady);
+    if (spaceReady) vSemaphoreDelete(spaceReady);
+  }
+
+  bool begin(size_t bytes = NET_RING_BYTES) {
+    data = (uint8_t*)regionMalloc(bytes, REGION_INTERNAL);
+    dataReady = xSemaphoreCreateBinary();
+    spaceReady = xSemaphoreCreateBinary();
+    size = data ? bytes : 0;
+    return data && dataReady && spaceReady;
+  }
+
+  // New session (both sides idle)
+  void reset() {
+    portENTER_CRITICAL(&lock);
+    head = tail = 0;
+    closed = aborted = false;
+    portEXIT_CRITICAL(&lock);
+    xSemaphoreTake(dataReady, 0);
+    xSemaphoreTake(spaceReady, 0);
+  }
+
+  // Producer: contiguous free span, waiting up to wait for one; 0 once
+  // the consumer aborted (or on timeout)
+  size_t writeSpan(uint8_t*& p, TickType_t wait) {
+    while (true) {
+      portENTER_CRITICAL(&lock);
+      size_t used = head - tail;
+      bool gone = aborted;
+      portEXIT_CRITICAL(&lock);
+      if (gone) return 0;
+
+      if (used < size) {
+        size_t at = head % size;
+        p = data + at;
+        return min(size - used, size - at);
+      }
+      if (xSemaphoreTake(spaceReady, wait) != pdTRUE) return 0;
+    }
+  }
+
+  void commitWrite(size_t n) {
+    portENTER_CRITICAL(&lock);
+    head += n;
+    portEXIT_CRITICAL(&lock);
+    xSemaphoreGive(dataReady);
+  }
+
+  // Producer: no more bytes
+  void close() {
+    portENTER_CRITICAL(&lock);
+    closed = true;
+    portEXIT_CRITICAL(&lock);
+    xSemaphoreGive(dataReady);
+  }
+
+  // Consumer: contiguous filled span, waiting up to wait for one; 0 at
+  // the end of the session (closed and drained) or on timeout
+  size_t readSpan(const uint8_t*& p, TickType_t wait) {
+    while (true) {
+      portENTER_CRITICAL(&lock);
+      size_t used = head - tail;
+      bool done = closed;
+      portEXIT_CRITICAL(&lock);
+
+      if (used > 0) {
+        size_t at = tail % size;
+        p = data + at;
+        return min(used, size - at);
+      }
+      if (done) return 0;
+      if (xSemaphoreTake(dataReady, wait) != pdTRUE) return 0;
+    }
+  }
+
+  void commitRead(size_t n) {
+    portENTER_CRITICAL(&lock);
+    tail += n;
+    portEXIT_CRITICAL(&lock);
+    xSemaphoreGive(spaceReady);
+  }
+
+  // Consumer: stop the session (job cancelled, printer failed)
+  void abort() {
+    portENTER_CRITICAL(&lock);
+    aborted = true;
+    portEXIT_CRITICAL(&lock);
+    xSemaphoreGive(spaceReady);
+  }
+
+  // Producer has closed and every byte was consumed
+  bool isDrained() {
+    portENTER_CRITICAL(&lock);
+    bool drained = closed && head == tail;
+    portEXIT_CRITICAL(&lock);
+    return drained;
+  }
+
+  bool isAborted() {
+    portENTER_CRITICAL(&lock);
+    bool gone = aborted;
+    portEXIT_CRITICAL(&lock);
+    return gone;
+  }
+
+  bool isValid() const { return data != nullptr; }
+};
+
+// Port-9100 passthrough. One session at a time: onSession() is called
+// when a client connects and returns false to turn it away (e.g. queue
+// full); the bytes then stream through the ring until the client closes
+// or goes quiet. The next client is accepted once the consumer has
+// drained or aborted the session.
+class RawPrintServer {
+public:
+  typedef bool (*SessionHook)(ByteRing& ring, void* ctx);
+
+private:
+  ByteRing ring;
+  SessionHook onSession;
+  void* hookCtx;
+  uint16_t port;
+
+  static void taskEntry(void* param) {
+    ((RawPrintServer*)param)->run();
+  }
+
+  void run() {
+    while (WiFi.status() != WL_CONNECTED) {
+      vTaskDelay(pdMS_TO_TICKS(500));
+    }
+    WiFiServer server(port);
+    server.begin();
+    Serial.printf("✓ Raw print port: %s:%d\n", WiFi.localIP().toString().c_str(), port);
+
+    while (true) {
+      WiFiClient client = server.available();
+      if (!client) {
+        vTaskDelay(pdMS_TO_TICKS(50));
+        continue;
+      }
+
+      ring.reset();
+      if (!onSession(ring, hookCtx)) {
+        client.stop();
+        continue;
+      }
+      pump(client);
+      client.stop();
+
+      // Keep later clients waiting until the printer has taken everything
+      while (!ring.isDrained() && !ring.isAborted()) {
+        vTaskDelay(pdMS_TO_TICKS(20));
+      }
+    }
+  }
+
+  // Socket -> ring until the client closes, goes quiet or is aborted
+  void pump(WiFiClient& client) {
+    uint32_t lastData = millis();
+    while (client.connected() || client.available()) {
+      uint8_t* p;
+      size_t room = ring.writeSpan(p, pdMS_TO_TICKS(100));
+      if (ring.isAborted()) break;
+      if (room == 0) {
+        lastData = millis();      // Full ring: the printer is the bottleneck
+        continue;
+      }
+
+      int got = client.available() ? client.read(p, room) : 0;
+      if (got > 0) {
+        ring.commitWrite(got);
+        lastData = millis();
+      } else if (millis() - lastData > NET_IDLE_TIMEOUT_MS) {
+        break;
+      } else {
+        vTaskDelay(pdMS_TO_TICKS(2));
+      }
+    }
+    ring.close();
+  }
+
+public:
+  RawPrintServer() : onSession(nullptr), hookCtx(nullptr), port(NET_RAW_PORT) {}
+
+  // Start listening (the task waits for Wi-Fi)
+  bool begin(SessionHook hook, void* ctx, uint16_t listenPort = NET_RAW_PORT) {
+    onSession = hook;
+    hookCtx = ctx;
+    port = listenPort;
+    if (!ring.begin(NET_RING_BYTES)) return false;
+    return xTaskCreatePinnedToCore(taskEntry, "NetRaw", NET_TASK_STACK, this, 1, NULL,
+                                   NET_TASK_CORE) == pdPASS;
+  }
+};
+
+// Minimal HTTP/1.1 front-end for sample submission: POST /samples with a
+// sample frame as the body. The hook reads the body from the connection
+// and fills in the status line and a short text reply.
+class SampleHttpServer {
+public:
+  typedef uint16_t (*PostHook)(Stream& body, size_t length, char* reply, size_t replyLen, void* ctx);
+
+private:
+  PostHook onPost;
+  void* hookCtx;
+  uint16_t port;
+
+  static void taskEntry(void* param) {
+    ((SampleHttpServer*)param)->run();
+  }
+
+  // One header line without CR LF; false on timeout or an over-long line
+  static bool readLine(WiFiClient& client, char* line, size_t len) {
+    size_t n = 0;
+    uint32_t start = millis();
+    while (millis() - start < NET_HTTP_TIMEOUT_MS) {
+      int c = client.read();
+      if (c < 0) {
+        if (!client.connected()) return false;
+        vTaskDelay(pdMS_TO_TICKS(1));
+        continue;
+      }
+      if (c == '\n') {
+        if (n > 0 && line[n - 1] == '\r') n--;
+        line[n] = '\0';
+        return true;
+      }
+      if (n + 1 >= len) return false;
+      line[n++] = (char)c;
+    }
+    return false;
+  }
+
+  static void respond(WiFiClient& client, uint16_t status, const char* text) {
+    const char* reason = status == 202 ? "Accepted" : status == 400 ? "Bad Request" :
+                         status == 404 ? "Not Found" : status == 503 ? "Service Unavailable" : "Error";
+    client.printf("HTTP/1.1 %d %s\r\nContent-Type: text/plain\r\nConnection: close\r\n", status, reason);
+    if (status == 503) client.print("Retry-After: 1\r\n");
+    client.printf("Content-Length: %d\r\n\r\n%s\n", (int)strlen(text) + 1, text);
+  }
+
+  void handle(WiFiClient& client) {
+    char line[128];
+    if (!readLine(client, line, sizeof(line))) return;
+    bool post = strncmp(line, "POST /samples ", 14) == 0;
+
+    size_t length = 0;
+    while (readLine(client, line, sizeof(line)) && line[0]) {
+      if (strncasecmp(line, "Content-Length:", 15) == 0) {
+        length = strtoul(line + 15, nullptr, 10);
+      }
+    }
+
+    if (!post) {
+      respond(client, 404, "POST a sample frame to /samples");
+      return;
+    }
+
+    char reply[64];
+    client.setTimeout(NET_HTTP_TIMEOUT_MS);
+    uint16_t status = onPost(client, length, reply, sizeof(reply), hookCtx);
+    respond(client, status, reply);
+  }
+
+  void run() {
+    while (WiFi.status() != WL_CONNECTED) {
+      vTaskDelay(pdMS_TO_TICKS(500));
+    }
+    WiFiServer server(port);
+    server.begin();
+    Serial.printf("✓ Sample endpoint: http://%s:%d/samples\n", WiFi.localIP().toString().c_str(), port);
+
+    // Requests are short: one at a time, the rest wait in the backlog
+    while (true) {
+      WiFiClient client = server.available();
+      if (!client) {
+        vTaskDelay(pdMS_TO_TICKS(20));
+        continue;
+      }
+      handle(client);
+      client.flush();     // Drop unread body bytes before closing
+      client.stop();
+    }
+  }
+
+public:
+  SampleHttpServer() : onPost(nullptr), hookCtx(nullptr), port(NET_HTTP_PORT) {}
+
+  bool begin(PostHook hook, void* ctx, uint16_t listenPort = NET_HTTP_PORT) {
+    onPost = hook;
+    hookCtx = ctx;
+    port = listenPort;
+    return xTaskCreatePinnedToCore(taskEntry, "NetHttp", NET_TASK_STACK, this, 1, NULL,
+                                   NET_TASK_CORE) == pdPASS;
+  }
+};
+
+#endif // NET_PRINT_SERVER_H
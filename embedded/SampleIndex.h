@@ -0,0 +1,188 @@
+/*
+ * SampleIndex.h
+ * Multi-resolution min / max index over a large sample buffer
+ * Level 0 holds the min and max of every SAMPLE_INDEX_BLOCK samples, each
+ * further level halves the previous one. Any sample range is answered
+ * from O(log n) entries plus at most two partial blocks, so a 500k-sample
+ * capture is re-plotted at another scale or zoom window without
+ * rescanning it: a page costs ~1k queries instead of 500k reads.
+ * The index is ~len / 4 bytes (PSRAM when available); the samples are
+ * not copied and must outlive it.
+ */
+
+#ifndef SAMPLE_INDEX_H
+#define SAMPLE_INDEX_H
+
+#include <Arduino.h>
+#include "CurveReducer.h"
+#include "JobArena.h"
+
+// Samples per level-0 entry (power of 2)
+#define SAMPLE_INDEX_BLOCK 32
+
+// Levels kept (enough for 32 * 2^23 samples)
+#define SAMPLE_INDEX_LEVELS 24
+
+class MinMaxIndex {
+private:
+  struct Range {
+    int16_t lo;
+    int16_t hi;
+  };
+
+  const int16_t* data;
+  uint32_t len;
+  Range* nodes;                             // All levels, level 0 first
+  uint32_t levelStart[SAMPLE_INDEX_LEVELS];
+  uint32_t levelCount[SAMPLE_INDEX_LEVELS];
+  uint8_t levels;
+
+  static void merge(Range& r, int16_t lo, int16_t hi) {
+    if (lo < r.lo) r.lo = lo;
+    if (hi > r.hi) r.hi = hi;
+  }
+
+  void scan(Range& r, uint32_t from, uint32_t to) const {
+    for (uint32_t i = from; i < to; i++) {
+      merge(r, data[i], data[i]);
+    }
+  }
+
+  // Not copyable (owns the node table)
+  MinMaxIndex(const MinMaxIndex&);
+  MinMaxIndex& operator=(const MinMaxIndex&);
+
+public:
+  MinMaxIndex() : data(nullptr), len(0), nodes(nullptr), levels(0) {}
+
+  ~MinMaxIndex() {
+    regionFree(nodes);
+  }
+
+  // Build the index over samples[0, count): one pass over the samples
+  bool begin(const int16_t* samples, uint32_t count) {
+    regionFree(nodes);
+    nodes = nullptr;
+    data = samples;
+    len = samples ? count : 0;
+    levels = 0;
+    if (len == 0) return false;
+
+    uint32_t total = 0;
+    uint32_t n = (len + SAMPLE_INDEX_BLOCK - 1) / SAMPLE_INDEX_BLOCK;
+    while (levels < SAMPLE_INDEX_LEVELS) {
+      levelStart[levels] = total;
+      levelCount[levels] = n;
+      total += n;
+      levels++;
+      if (n == 1) break;
+      n = (n + 1) / 2;
+    }
+
+    nodes = (Range*)regionMalloc(total * sizeof(Range), REGION_PSRAM);
+    if (!nodes) {
+      Serial.println("  ✗ Sample index not allocated!");
+      levels = 0;
+      return false;
+    }
+
+    Range* level = nodes;
+    for (uint32_t b = 0; b < levelCount[0]; b++) {
+      Range r = {INT16_MAX, INT16_MIN};
+      scan(r, b * SAMPLE_INDEX_BLOCK, min(len, (b + 1) * SAMPLE_INDEX_BLOCK));
+      level[b] = r;
+    }
+    for (uint8_t k = 1; k < levels; k++) {
+      const Range* below = nodes + levelStart[k - 1];
+      level = nodes + levelStart[k];
+      for (uint32_t b = 0; b < levelCount[k]; b++) {
+        Range r = below[2 * b];
+        if (2 * b + 1 < levelCount[k - 1]) merge(r, below[2 * b + 1].lo, below[2 * b + 1].hi);
+        level[b] = r;
+      }
+    }
+    return true;
+  }
+
+  // Min and max of samples [from, to); an empty range gives lo > hi
+  void query(uint32_t from, uint32_t to, int16_t& lo, int16_t& hi) const {
+    Range r = {INT16_MAX, INT16_MIN};
+    if (to > len) to = len;
+
+    uint32_t a = from;
+    uint32_t b = to;
+    if (!nodes) {
+      scan(r, a, b);      // No index: plain scan
+    } else {
+      // Partial blocks at both ends come from the samples
+      uint32_t headEnd = min(b, (a + SAMPLE_INDEX_BLOCK - 1) & ~(uint32_t)(SAMPLE_INDEX_BLOCK - 1));
+      scan(r, a, headEnd);
+      a = headEnd;
+      if (b != len) {
+        uint32_t tailStart = max(a, b & ~(uint32_t)(SAMPLE_INDEX_BLOCK - 1));
+        scan(r, tailStart, b);
+        b = tailStart;
+      }
+
+      // Whole blocks [i0, i1) (the last one may be short): climb while
+      // the range has aligned pairs
+      uint32_t i0 = a / SAMPLE_INDEX_BLOCK;
+      uint32_t i1 = a < b ? (b + SAMPLE_INDEX_BLOCK - 1) / SAMPLE_INDEX_BLOCK : i0;
+      for (uint8_t k = 0; k < levels && i0 < i1; k++) {
+        const Range* level = nodes + levelStart[k];
+        if (k == levels - 1) {
+          for (; i0 < i1; i0++) merge(r, level[i0].lo, level[i0].hi);
+          break;
+        }
+        if (i0 & 1) {
+          merge(r, level[i0].lo, level[i0].hi);
+          i0++;
+        }
+        if ((i1 & 1) && i1 != levelCount[k]) {
+          i1--;
+          merge(r, level[i1].lo, level[i1].hi);
+        }
+        i0 /= 2;
+        i1 = (i1 + 1) / 2;
+      }
+    }
+
+    lo = r.lo;
+    hi = r.hi;
+  }
+
+  bool isValid() const { return nodes != nullptr; }
+  uint32_t length() const { return len; }
+  const int16_t* samples() const { return data; }
+  size_t memoryBytes() const {
+    return levels ? (levelStart[levels - 1] + levelCount[levels - 1]) * sizeof(Range) : 0;
+  }
+};
+
+// Window [from, from + count) of an indexed buffer as a curve source:
+// the reducer's row buckets are index queries instead of sample reads,
+// so zooming or re-plotting only costs the rows drawn
+class IndexedSource : public SampleSource {
+private:
+  const MinMaxIndex* index;
+  uint32_t first;
+  uint32_t len;
+  uint32_t pos;
+
+public:
+  IndexedSource(const MinMaxIndex& idx, uint32_t from = 0, uint32_t count = UINT32_MAX)
+    : index(&idx), first(min(from, idx.length())), pos(0) {
+    len = min(count, idx.length() - first);
+  }
+
+  uint32_t length() const { return len; }
+  void rewind() { pos = 0; }
+  int16_t next() { return pos < len ? index->samples()[first + pos++] : 0; }
+
+  bool isIndexed() const { return index->isValid(); }
+  void rangeMinMax(uint32_t from, uint32_t to, int16_t& lo, int16_t& hi) {
+    index->query(first + from, first + min(to, len), lo, hi);
+  }
+};
+
+#endif // SAMPLE_INDEX_H
@@ -0,0 +1,271 @@
+/*
+ * StripChart.h
+ * Live strip-chart printing for thermal printers
+ * Samples are pushed as they arrive; every band of rows is rendered
+ * (grid, time labels and curve) and printed as soon as the curve rows
+ * it shows are known, like a chart recorder. A sample is on paper at
+ * most one band plus getLagRows() rows after it arrived. Memory is one
+ * band buffer and a small row ring, however long the run.
+ *
+ * Rows are counted from the first graph row; the header with the
+ * pressure labels is the topMargin rows before it, so the paper looks
+ * like the top of a GraphGenerator page that never ends.
+ */
+
+#ifndef STRIP_CHART_H
+#define STRIP_CHART_H
+
+#include <Arduino.h>
+#include "BitmapCanvas.h"
+#include "CurveReducer.h"
+#include "GraphGenerator.h"
+#include "ThermalPrinter.h"
+#include "BandRenderer.h"
+#include "BandPipeline.h"
+#include "JobArena.h"
+#include "Stats.h"
+
+// Rows a rotated time label may reach below its grid line
+#define STRIP_LABEL_REACH 160
+
+class StripChart {
+private:
+  uint16_t width;
+  uint16_t graphStartX;
+  uint16_t topMargin;
+  uint16_t xStep;
+  uint16_t yMax;
+  uint16_t yStep;
+  uint16_t gridXSpacing;
+  uint16_t gridYSpacing;
+  uint16_t graphWidth;
+  uint32_t scaleQ16;        // Q16 dots per sample unit (as GraphGenerator)
+
+  uint16_t samplesPerRow;
+  uint16_t bandRows;
+  uint8_t thickness;
+  bool dashed;
+
+  BitmapCanvas band;
+  int16_t* rowX;            // X of the last rows, indexed by row % ringRows
+  uint16_t ringRows;
+  bool rowsOwned;           // rowX was malloc'd here (no arena)
+  LiveCurveReducer reducer;
+
+  ThermalPrinter* printers[PIPELINE_MAX_PORTS];   // Fed with the same chart
+  uint8_t printerCount;
+
+  int32_t rowsReady;        // Graph rows with a known curve point
+  int32_t nextBand;         // First row of the next band to print
+  bool running;
+
+  // Band-local row of chart row r (band starts at row start)
+  static int16_t local(int32_t r, int32_t start) { return (int16_t)(r - start); }
+
+  // Curve rows a band needs past its last row (thick line look-ahead)
+  int16_t lookAhead() const { return thickness / 2 + 1; }
+
+  void storeRow(int16_t value) {
+    int32_t top = (int32_t)yMax * SAMPLE_SCALE;
+    value = constrain(value, 0, top);
+    int16_t xOffset = ((uint32_t)value * scaleQ16) >> 16;
+    rowX[rowsReady % ringRows] = graphStartX + xOffset;
+    rowsReady++;
+  }
+
+  // Draw chart rows [start, start + rows) into the band buffer
+  void renderBand(int32_t start, uint16_t rows) {
+    STATS_SCOPE(STAT_BAND_RENDER);
+    band.clear();
+    int32_t end = start + rows;
+    uint16_t numYDiv = yMax / yStep;
+    char label[12];
+
+    // Header: pressure labels across the top
+    if (start < 0) {
+      for (uint16_t i = 1; i <= numYDiv; i++) {
+        sprintf(label, "%dK", i * yStep);
+        band.drawText(label, graphStartX + i * gridYSpacing - 13,
+                      local(5 - (int32_t)topMargin, start), 2, true);
+      }
+    }
+
+    // Grid
+    int32_t gridFrom = max(start, (int32_t)0);
+    if (gridFrom < end) {
+      for (uint16_t i = 0; i <= numYDiv; i++) {
+        band.drawVerticalLine(graphStartX + i * gridYSpacing,
+                              local(gridFrom, start), rows, dashed);
+      }
+      int32_t r = (gridFrom + gridXSpacing - 1) / gridXSpacing * gridXSpacing;
+      for (; r < end; r += gridXSpacing) {
+        band.drawHorizontalLine(local(r, start), graphStartX, graphStartX + graphWidth, dashed);
+      }
+    }
+
+    // Time labels (rotated, starting 3 rows above their grid line);
+    // 1x once a label no longer fits between two lines at 2x
+    int32_t k = start > STRIP_LABEL_REACH ? (start - STRIP_LABEL_REACH) / gridXSpacing : 0;
+    for (; k * gridXSpacing - 3 < end; k++) {
+      int32_t top = k * gridXSpacing - 3;
+      uint8_t len = sprintf(label, "%lu", (unsigned long)k * xStep);
+      uint8_t size = len * 16 + 8 <= gridXSpacing ? 2 : 1;
+      if (top + len * 8 * size > start) {
+        band.drawText(label, 10, local(top, start), size, true);
+      }
+    }
+
+    STATS_SCOPE(STAT_CURVE);
+    int32_t half = thickness / 2;
+    int32_t first = max(start - half - 1, (int32_t)0);
+    int32_t last = min(end - 1 + half, rowsReady - 1);
+    if (first > last) return;
+
+    ThickPolyline<BitmapCanvas> line(band, thickness);
+    line.moveTo(rowX[first % ringRows], local(first, start));
+    for (int32_t y = first + 1; y <= last; y++) {
+      line.lineTo(rowX[y % ringRows], local(y, start));
+    }
+  }
+
+  // Print every band that is complete (all bands when flushing)
+  bool pump(bool flushing) {
+    while (running) {
+      int32_t remaining = flushing ? rowsReady - nextBand
+                                   : rowsReady - lookAhead() - nextBand;
+      if (remaining < (flushing ? 1 : (int32_t)bandRows)) return true;
+
+      uint16_t rows = min((int32_t)bandRows, remaining);
+      renderBand(nextBand, rows);
+
+      STATS_SCOPE(STAT_TRANSMIT);
+      for (uint8_t p = 0; p < printerCount; p++) {
+        if (!printers[p]->printBitmap(width, rows, band.getData())) {
+          Serial.printf("  ✗ Strip chart band at row %ld failed!\n", (long)nextBand);
+          running = false;
+          return false;
+        }
+      }
+      nextBand += rows;
+    }
+    return false;
+  }
+
+public:
+  // rows: band height, a multiple of 8 (keeps the dashes continuous)
+  StripChart(uint16_t w, uint16_t lm, uint16_t tm,
+             uint16_t xstp, uint16_t ymax, uint16_t ystp,
+             uint16_t gridX, uint16_t gridY,
+             uint16_t perRow, uint16_t rows = BAND_ROWS_DEFAULT,
+             JobArena* arena = nullptr)
+    : width(w), graphStartX(lm), topMargin(tm),
+      xStep(xstp), yMax(ymax), yStep(ystp),
+      gridXSpacing(gridX), gridYSpacing(gridY),
+      samplesPerRow(perRow), bandRows(rows), thickness(1), dashed(true),
+      band(w, rows, arena ? (uint8_t*)arena->alloc(BitmapCanvas::bufferSize(w, rows)) : nullptr),
+      rowX(nullptr), ringRows(rows + CURVE_HISTORY), rowsOwned(false),
+      printerCount(0), rowsReady(0), nextBand(0), running(false)
+  {
+    graphWidth = gridYSpacing * (yMax / yStep);
+    uint32_t top = (uint32_t)yMax * SAMPLE_SCALE;
+    scaleQ16 = top ? (((uint32_t)graphWidth << 16) + top / 2) / top : 0;
+
+    // Buffers come from the job's arena when it has room
+    if (arena) rowX = arena->allocArray<int16_t>(ringRows);
+    if (!rowX) {
+      rowX = (int16_t*)malloc(ringRows * sizeof(int16_t));
+      rowsOwned = true;
+    }
+  }
+
+  // Geometry from a GraphLayout; perRow (samples max-pooled per row) sets
+  // the time scale: sample rate / perRow = rows per second
+  template <class Layout>
+  StripChart(Layout, uint16_t perRow, uint16_t rows = BAND_ROWS_DEFAULT,
+             JobArena* arena = nullptr)
+    : StripChart(Layout::WIDTH, Layout::LEFT_MARGIN, Layout::TOP_MARGIN,
+                 Layout::X_STEP, Layout::Y_MAX, Layout::Y_STEP,
+                 Layout::GRID_X_SPACING, Layout::GRID_Y_SPACING,
+                 perRow, rows, arena) {}
+
+  ~StripChart() {
+    if (rowsOwned) free(rowX);
+  }
+
+  bool isValid() const {
+    return band.isValid() && rowX && bandRows % 8 == 0 &&
+           yStep > 0 && gridXSpacing > 0;
+  }
+
+  // Layer options (set before begin())
+  void setGridDashed(bool d) { dashed = d; }
+  void setCurveThickness(uint8_t t) { thickness = min(t, (uint8_t)(LINE_SPAN_RING - 2)); }
+
+  // Start a chart on one or several printers and print its header
+  bool begin(ThermalPrinter* const* ports, uint8_t count) {
+    if (!isValid() || count == 0) return false;
+
+    printerCount = min(count, (uint8_t)PIPELINE_MAX_PORTS);
+    for (uint8_t p = 0; p < printerCount; p++) {
+      printers[p] = ports[p];
+    }
+
+    reducer.begin(samplesPerRow);
+    rowsReady = 0;
+    nextBand = -(int32_t)topMargin;
+    running = true;
+    return pump(false);
+  }
+
+  bool begin(ThermalPrinter& printer) {
+    ThermalPrinter* ports[] = {&printer};
+    return begin(ports, 1);
+  }
+
+  // Add one sample (1/SAMPLE_SCALE units); prints the bands it completes.
+  // False once the chart is stopped or a printer failed.
+  bool addSample(int16_t value) {
+    if (!running) return false;
+
+    reducer.push(value);
+    int16_t row;
+    while (reducer.next(row)) {
+      storeRow(row);
+      if (!pump(false)) return false;
+    }
+    return true;
+  }
+
+  bool addSamples(const int16_t* values, uint16_t count) {
+    for (uint16_t i = 0; i < count; i++) {
+      if (!addSample(values[i])) return false;
+    }
+    return true;
+  }
+
+  // End the chart: the curve is closed and the last (short) band printed
+  bool finish() {
+    if (!running) return false;
+
+    reducer.flush();
+    int16_t row;
+    bool ok = true;
+    while (ok && reducer.next(row)) {
+      storeRow(row);
+      ok = pump(false);
+    }
+    ok = ok && pump(true);
+    running = false;
+    return ok;
+  }
+
+  // Rows a sample waits for beyond its band: smoothing window and line
+  uint16_t getLagRows() const { return CURVE_SMOOTH_WINDOW / 2 + lookAhead(); }
+
+  // Getters
+  bool isRunning() const { return running; }
+  uint32_t getRows() const { return rowsReady; }
+  uint16_t getBandRows() const { return bandRows; }
+};
+
+#endif // STRIP_CHART_H
@@ -0,0 +1,327 @@
+/*
+ * BandPipeline.h
+ * Double-buffered render/transmit pipeline for ESP32-S3
+ * A render task pinned to one core fills band buffers while the calling
+ * task drains finished bands to the printer UART on the other core.
+ * Render time is hidden behind the (much slower) serial transfer.
+ * A page can also be fanned out to several printers: every band is
+ * rendered once and streamed to each port by its own sender task.
+ */
+
+#ifndef BAND_PIPELINE_H
+#define BAND_PIPELINE_H
+
+#include <Arduino.h>
+#include "BitmapCanvas.h"
+#include "BandRenderer.h"
+#include "ThermalPrinter.h"
+#include "JobArena.h"
+
+// Band buffers in the ring (2 = classic double buffering)
+#define PIPELINE_MAX_DEPTH 4
+
+// Printers one page can be fanned out to
+#define PIPELINE_MAX_PORTS 3
+
+// Render task settings
+#define PIPELINE_RENDER_CORE  1
+#define PIPELINE_RENDER_STACK 4096
+
+// Sender tasks for ports after the first (port 0 is the calling task)
+#define PIPELINE_SEND_CORE  0
+#define PIPELINE_SEND_STACK 3072
+
+class BandPipeline {
+private:
+  // Band handed from the render task to the sender
+  struct BandSlot {
+    uint8_t slot;     // Index into bands[]
+    uint16_t index;   // Band number on the page (BAND_END = no more bands)
+  };
+
+  // Sender task argument
+  struct PortContext {
+    BandPipeline* pipeline;
+    uint8_t port;
+  };
+
+  static const uint16_t BAND_END = 0xFFFF;
+
+  BandRenderer* renderer;     // Page being printed (set per job)
+  BitmapCanvas* bands[PIPELINE_MAX_DEPTH];
+  uint8_t* bandMemory;        // One internal-RAM block for all bands
+  uint16_t bandWidth;
+  uint16_t bandRows;
+  uint8_t depth;
+  uint8_t renderCore;
+
+  // Per-port state (set per job)
+  ThermalPrinter* printers[PIPELINE_MAX_PORTS];
+  QueueHandle_t readyQueues[PIPELINE_MAX_PORTS];  // Rendered bands waiting for each UART
+  PortContext contexts[PIPELINE_MAX_PORTS];
+  volatile bool portFailed[PIPELINE_MAX_PORTS];
+  uint8_t numPorts;
+
+  // Every port hands a slot back once it is done with it; refs[] counts
+  // the handbacks still due. Only the render task touches it.
+  QueueHandle_t freeQueue;    // Slot handbacks
+  uint8_t refs[PIPELINE_MAX_DEPTH];
+  TaskHandle_t senderTask;    // Calling task (waits for all helpers)
+  volatile bool aborted;      // Render and send no further bands
+  volatile bool stopped;      // Band hook ended the page
+
+  // Render stops once no port is sending any more
+  bool allPortsFailed() const {
+    for (uint8_t p = 0; p < numPorts; p++) {
+      if (!portFailed[p]) return false;
+    }
+    return true;
+  }
+
+  // Producer: render every band into the next free slot
+  static void renderTaskEntry(void* param) {
+    BandPipeline* self = (BandPipeline*)param;
+    uint16_t count = self->renderer->bandCount();
+
+    for (uint16_t i = 0; i < count && !self->aborted; i++) {
+      uint8_t slot;
+      do {
+        xQueueReceive(self->freeQueue, &slot, portMAX_DELAY);
+      } while (--self->refs[slot] > 0);
+      if (self->aborted) break;
+
+      self->renderer->renderBand(i, *self->bands[slot]);
+
+      self->refs[slot] = self->numPorts;
+      BandSlot ready = {slot, i};
+      for (uint8_t p = 0; p < self->numPorts; p++) {
+        xQueueSend(self->readyQueues[p], &ready, portMAX_DELAY);
+      }
+    }
+
+    BandSlot end = {0, BAND_END};
+    for (uint8_t p = 0; p < self->numPorts; p++) {
+      xQueueSend(self->readyQueues[p], &end, portMAX_DELAY);
+    }
+
+    // Tell the caller this task is gone, then exit
+    xTaskNotifyGive(self->senderTask);
+    vTaskDelete(NULL);
+  }
+
+  // Consumer: stream every rendered band to one port. A failed port keeps
+  // handing slots back so the other ports are not held up.
+  void drainPort(uint8_t port) {
+    ThermalPrinter& printer = *printers[port];
+    uint16_t count = renderer->bandCount();
+
+    while (true) {
+      BandSlot ready;
+      xQueueReceive(readyQueues[port], &ready, portMAX_DELAY);
+      if (ready.index == BAND_END) break;
+
+      // Port 0 owns the page's preemption / cancellation point
+      if (port == 0 && !aborted && !renderer->bandBoundary(ready.index, printer)) {
+        Serial.printf("  ✗ Page stopped before band %d\n", ready.index);
+        stopped = true;
+        aborted = true;
+      }
+
+      if (!portFailed[port] && !aborted) {
+        BitmapCanvas* band = bands[ready.slot];
+        if (!renderer->sendBand(ready.index, *band, printer, true)) {
+          if (numPorts > 1) {
+            Serial.printf("  ✗ Printer %d: band %d transmission failed!\n", port, ready.index);
+          } else {
+            Serial.printf("  ✗ Band %d transmission failed!\n", ready.index);
+          }
+          portFailed[port] = true;
+          if (allPortsFailed()) aborted = true;
+        }
+        
+        // Yield until the band is queued in the UART driver; the slot
+        // can then be reused while the driver drains it to the wire
+        {
+          STATS_SCOPE(STAT_STALL);
+          while (printer.poll() == ASYNC_SENDING) {
+            vTaskDelay(1);
+          }
+        }
+        
+        if (port == 0 && !portFailed[port] &&
+            ((ready.index + 1) % 5 == 0 || ready.index + 1 == count)) {
+          Serial.printf("  Progress: %d%%\n", ((ready.index + 1) * 100) / count);
+        }
+      }
+
+      // Hand the slot back (also unblocks the renderer after an abort)
+      xQueueSend(freeQueue, &ready.slot, portMAX_DELAY);
+    }
+    
+    // Let the last band leave the UART
+    STATS_SCOPE(STAT_STALL);
+    while (printer.poll() != ASYNC_IDLE) {
+      vTaskDelay(1);
+    }
+  }
+
+  static void senderTaskEntry(void* param) {
+    PortContext* ctx = (PortContext*)param;
+    ctx->pipeline->drainPort(ctx->port);
+
+    xTaskNotifyGive(ctx->pipeline->senderTask);
+    vTaskDelete(NULL);
+  }
+
+public:
+  // Band buffers are allocated once and reused for every job
+  BandPipeline(uint16_t width, uint16_t rows = BAND_ROWS_DEFAULT,
+               uint8_t numBands = 2, uint8_t core = PIPELINE_RENDER_CORE)
+    : renderer(nullptr), bandMemory(nullptr), bandWidth(width), bandRows(rows),
+      depth(0), renderCore(core), numPorts(0),
+      freeQueue(nullptr), senderTask(nullptr), aborted(false),
+      stopped(false)
+  {
+    if (numBands < 2) numBands = 2;
+    if (numBands > PIPELINE_MAX_DEPTH) numBands = PIPELINE_MAX_DEPTH;
+
+    for (uint8_t i = 0; i < PIPELINE_MAX_DEPTH; i++) {
+      bands[i] = nullptr;
+    }
+
+    // Bands are rewritten every row, so they stay in internal RAM (plain
+    // malloc may put blocks this size in PSRAM); fewer if memory is short
+    size_t bandBytes = (BitmapCanvas::bufferSize(bandWidth, bandRows) + 3) & ~(size_t)3;
+    while (numBands >= 2 &&
+           !(bandMemory = (uint8_t*)regionMalloc(bandBytes * numBands, REGION_INTERNAL))) {
+      numBands--;
+    }
+
+    for (uint8_t i = 0; bandMemory && i < numBands; i++) {
+      bands[i] = new BitmapCanvas(bandWidth, bandRows, bandMemory + i * bandBytes);
+      depth++;
+    }
+
+    freeQueue = xQueueCreate(PIPELINE_MAX_DEPTH * PIPELINE_MAX_PORTS, sizeof(uint8_t));
+    for (uint8_t p = 0; p < PIPELINE_MAX_PORTS; p++) {
+      printers[p] = nullptr;
+      readyQueues[p] = xQueueCreate(PIPELINE_MAX_DEPTH + 1, sizeof(BandSlot));
+      contexts[p].pipeline = this;
+      contexts[p].port = p;
+      portFailed[p] = false;
+    }
+  }
+
+  ~BandPipeline() {
+    for (uint8_t i = 0; i < PIPELINE_MAX_DEPTH; i++) {
+      delete bands[i];
+    }
+    regionFree(bandMemory);
+    if (freeQueue) vQueueDelete(freeQueue);
+    for (uint8_t p = 0; p < PIPELINE_MAX_PORTS; p++) {
+      if (readyQueues[p]) vQueueDelete(readyQueues[p]);
+    }
+  }
+
+  // Pipelining needs at least two band buffers
+  bool isValid() const {
+    if (depth < 2 || !freeQueue) return false;
+    for (uint8_t p = 0; p < PIPELINE_MAX_PORTS; p++) {
+      if (!readyQueues[p]) return false;
+    }
+    return true;
+  }
+
+  // Render and print the page. Transmission runs in the calling task;
+  // rendering runs in a temporary task pinned to the render core.
+  bool print(BandRenderer& page, ThermalPrinter& printer) {
+    ThermalPrinter* only = &printer;
+    return print(page, &only, 1);
+  }
+
+  // Render the page once and print it on count printers at the same time.
+  // Port 0 is fed by the calling task, the others by temporary sender
+  // tasks on the UART core. True only if every printer got the whole page.
+  // The renderer's band hook runs on port 0 (see BandRenderer::setBandHook).
+  bool print(BandRenderer& page, ThermalPrinter* const* ports, uint8_t count) {
+    if (!isValid()) {
+      Serial.println("  ✗ Band pipeline not allocated!");
+      return false;
+    }
+    
+    if (page.getWidth() != bandWidth || page.getBandRows() > bandRows) {
+      Serial.println("  ✗ Page bands do not fit pipeline buffers!");
+      return false;
+    }
+    
+    if (count == 0 || count > PIPELINE_MAX_PORTS) {
+      Serial.printf("  ✗ Pipeline supports 1-%d printers!\n", PIPELINE_MAX_PORTS);
+      return false;
+    }
+    
+    renderer = &page;
+
+    xQueueReset(freeQueue);
+    for (uint8_t i = 0; i < depth; i++) {
+      refs[i] = 1;
+      xQueueSend(freeQueue, &i, 0);
+    }
+    printers[0] = ports[0];
+    for (uint8_t p = 0; p < PIPELINE_MAX_PORTS; p++) {
+      portFailed[p] = false;
+      xQueueReset(readyQueues[p]);
+    }
+
+    aborted = false;
+    stopped = false;
+    senderTask = xTaskGetCurrentTaskHandle();
+    ulTaskNotifyTake(pdTRUE, 0);  // Drop any stale notification
+
+    // Extra ports first, so the render task knows how many consume bands
+    bool ok = true;
+    uint8_t started = 1;
+    for (uint8_t p = 1; p < count; p++) {
+      printers[started] = ports[p];
+      if (xTaskCreatePinnedToCore(senderTaskEntry, "BandSend", PIPELINE_SEND_STACK,
+                                  &contexts[started], uxTaskPriorityGet(NULL), NULL,
+                                  PIPELINE_SEND_CORE) == pdPASS) {
+        started++;
+      } else {
+        Serial.printf("  ✗ Printer %d: sender task creation failed!\n", p);
+        ok = false;
+      }
+    }
+    numPorts = started;
+
+    if (xTaskCreatePinnedToCore(renderTaskEntry, "BandRender", PIPELINE_RENDER_STACK,
+                                this, uxTaskPriorityGet(NULL), NULL,
+                                renderCore) != pdPASS) {
+      Serial.println("  ✗ Render task creation failed!");
+      
+      // Release the senders already waiting for bands
+      BandSlot end = {0, BAND_END};
+      for (uint8_t p = 1; p < numPorts; p++) {
+        xQueueSend(readyQueues[p], &end, portMAX_DELAY);
+        ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+      }
+      return false;
+    }
+
+    drainPort(0);
+
+    // Wait for the render and sender tasks to exit before buffers can be reused
+    for (uint8_t k = 0; k < numPorts; k++) {
+      ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+    }
+    
+    for (uint8_t p = 0; p < numPorts; p++) {
+      if (portFailed[p]) ok = false;
+    }
+    return ok && !stopped;
+  }
+
+  // Getters
+  uint8_t getDepth() const { return depth; }
+};
+
+#endif // BAND_PIPELINE_H
@@ -205,22 +205,32 @@ static const uint8_t font5x7_data[][7] PROGMEM = {
   }
 };
 
+// Number of glyphs in font5x7_data
+#define FONT5X7_GLYPHS (sizeof(font5x7_data) / sizeof(font5x7_data[0]))
+
+// Character -> glyph index lookup (-1 = no glyph)
+static const int8_t font5x7_index[256] PROGMEM = {
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, 14, -1, -1, -1, 12, -1, 10, -1, 13, -1, -1,
+  15, -1, 16, 17, 11, 18, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, 14, -1, -1, -1, 12, -1, 10, -1, 13, -1, -1,
+  15, -1, 16, 17, 11, 18, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
 // Character index mapping
 inline int8_t getCharIndex(char c) {
-  if (c >= '0' && c <= '9') return c - '0';
-  
-  switch (c) {
-    case 'K': case 'k': return 10;
-    case 'T': case 't': return 11;
-    case 'I': case 'i': return 12;
-    case 'M': case 'm': return 13;
-    case 'E': case 'e': return 14;
-    case 'P': case 'p': return 15;
-    case 'R': case 'r': return 16;
-    case 'S': case 's': return 17;
-    case 'U': case 'u': return 18;
-    default: return -1;
-  }
+  return font5x7_index[(uint8_t)c];
 }
 
 // Get font character data
@@ -9,10 +9,127 @@
 
 #include <Arduino.h>
 #include "BitmapCanvas.h"
+#include "CurveReducer.h"
 
-class GraphGenerator {
+// Curve points remembered across bands (covers line thickness up to 14)
+#define CURVE_HISTORY 16
+
+// Curves overlaid on one graph (shared axes, one reduction / band pass)
+#define GRAPH_MAX_SERIES 4
+
+enum LineStyle {
+  LINE_SOLID = 0,
+  LINE_DASHED             // LINE_DASH_ROWS rows on, as many off
+};
+
+// How one series is drawn; thickness 0 = drawPreparedCurve()'s thickness
+struct SeriesStyle {
+  uint8_t thickness;
+  uint8_t style;          // LineStyle
+};
+
+// Synthetic build-up curve, generated sample by sample
+// pattern: 1 = Quadratic, 2 = Linear with noise
+class BuildUpSource : public SampleSource {
 private:
-  BitmapCanvas* canvas;
+  uint32_t numPoints;
+  uint32_t risePoints;
+  uint8_t pattern;
+  uint16_t yMax;
+  uint32_t seed;
+  
+  uint32_t randSeed;
+  uint32_t index;
+  
+  // Simple random number generator (LCG), uniform in [-amp, amp]
+  int16_t randomNoise(int16_t amp) {
+    // Linear Congruential Generator (31-bit state, top 16 bits used)
+    randSeed = (1103515245 * randSeed + 12345) & 0x7FFFFFFF;
+    uint32_t r = randSeed >> 15;
+    return (int16_t)(((r * (uint32_t)(2 * amp)) >> 16) - amp);
+  }
+  
+public:
+  BuildUpSource(uint32_t points, uint8_t pat, uint16_t ymax, uint32_t rngSeed)
+    : numPoints(points), pattern(pat), yMax(ymax), seed(rngSeed),
+      randSeed(rngSeed), index(0)
+  {
+    // Calculate rise time: 26 seconds out of 30 (86.7%)
+    risePoints = (uint32_t)(((uint64_t)numPoints * 26) / 30);
+  }
+  
+  bool isValid() const { return pattern == 1 || pattern == 2; }
+  uint32_t rngState() const { return randSeed; }
+  
+  uint32_t length() const { return isValid() ? numPoints : 0; }
+  
+  void rewind() {
+    randSeed = seed;
+    index = 0;
+  }
+  
+  int16_t next() {
+    uint32_t i = index++;
+    
+    // Sudden drop to 0
+    if (i >= risePoints) return 0;
+    
+    // Q16 progress through the rise
+    uint32_t progress = i < 65536 ? (i << 16) / risePoints
+                                  : (uint32_t)(((uint64_t)i << 16) / risePoints);
+    int32_t top = (int32_t)yMax * SAMPLE_SCALE;
+    int32_t value;
+    
+    if (pattern == 1) {
+      // PATTERN 1: Quadratic build-up (smooth acceleration)
+      uint32_t squared = (progress * progress) >> 16;
+      value = ((uint32_t)top * squared) >> 16;
+      value += randomNoise(3 * SAMPLE_SCALE);
+    } else {
+      // PATTERN 2: Linear with noise (steady rise)
+      value = ((uint32_t)top * progress) >> 16;
+      value += randomNoise(8 * SAMPLE_SCALE);
+    }
+    
+    return (int16_t)constrain(value, 0, top);
+  }
+};
+
+// Compile-time page geometry. Collects the graph #defines in one type so
+// the canvas dimensions are constants and the layout is checked at build
+// time; pass an instance to the generator constructor as a tag.
+template <uint16_t W, uint16_t H, uint16_t LM, uint16_t TM, uint16_t BM,
+          uint16_t XMAX, uint16_t XSTEP, uint16_t YMAX, uint16_t YSTEP,
+          uint16_t GX, uint16_t GY>
+struct GraphLayout {
+  static_assert(XSTEP > 0 && YSTEP > 0, "Axis steps must be non-zero");
+  static_assert(LM + GY * (YMAX / YSTEP) <= W, "Grid does not fit the paper width");
+  static_assert((uint32_t)YMAX * SAMPLE_SCALE <= 32767, "Y range exceeds int16 samples");
+  
+  static const uint16_t WIDTH = W;
+  static const uint16_t HEIGHT = H;
+  static const uint16_t LEFT_MARGIN = LM;
+  static const uint16_t TOP_MARGIN = TM;
+  static const uint16_t BOTTOM_MARGIN = BM;
+  static const uint16_t X_MAX = XMAX;
+  static const uint16_t X_STEP = XSTEP;
+  static const uint16_t Y_MAX = YMAX;
+  static const uint16_t Y_STEP = YSTEP;
+  static const uint16_t GRID_X_SPACING = GX;
+  static const uint16_t GRID_Y_SPACING = GY;
+  
+  static const uint16_t PAGE_HEIGHT = H + TM + BM;
+  static const uint16_t GRAPH_WIDTH = GY * (YMAX / YSTEP);
+  
+  // Full page and band buffers with this paper width
+  typedef FixedCanvas<W, PAGE_HEIGHT> Page;
+  template <uint16_t ROWS> using Band = FixedCanvas<W, ROWS>;
+};
+
+template <class Canvas>
+class BasicGraphGenerator {
+private:
+  Canvas* canvas;
   uint16_t width;
   uint16_t height;
   uint16_t leftMargin;
@@ -30,45 +147,96 @@ private:
   uint16_t graphStartX;
   uint16_t graphStartY;
   
-  // Simple random number generator (LCG)
+  // Q16 dots per sample unit (graphWidth / (yMax * SAMPLE_SCALE))
+  uint32_t scaleQ16;
+  
+  // One curve streamed from its source (one smoothed value per graph row)
+  struct Series {
+    SampleSource* source;
+    BufferSource buffer;          // Source for in-memory samples
+    CurveReducer reducer;
+    SeriesStyle style;
+    
+    // X positions of the last rows streamed, for segments crossing a band
+    // edge (historyLo: left end of the row's span, REDUCE_ENVELOPE)
+    int16_t history[CURVE_HISTORY];
+    int16_t historyLo[CURVE_HISTORY];
+  };
+  
+  Series series[GRAPH_MAX_SERIES];
+  uint8_t seriesCount;            // Prepared series (0 = no curve)
+  uint16_t curveLen;
+  uint16_t nextRow;               // Next graph row the reducers will produce
+  uint8_t reduction;              // CurveReduction of every series
+  
+  // Seed for generateBuildUpCurve()
   uint32_t randSeed;
   
-  float random_float(float min_val, float max_val) {
-    // Linear Congruential Generator
-    randSeed = (1103515245 * randSeed + 12345) & 0x7FFFFFFF;
-    float r = (float)randSeed / 0x7FFFFFFF;
-    return min_val + r * (max_val - min_val);
+  // Restart the streams at graph row 0
+  void rewindCurve() {
+    for (uint8_t s = 0; s < seriesCount; s++) {
+      series[s].reducer.begin(*series[s].source, curveLen, (CurveReduction)reduction);
+    }
+    nextRow = 0;
   }
   
-  // Moving average filter
-  void applyMovingAverage(float* data, uint16_t dataLen, uint8_t window = 5) {
-    if (window < 2 || !data) return;
+  // Reduce every series up to graph row y, row by row in lockstep; rows
+  // must be requested in ascending order from no further back than
+  // CURVE_HISTORY rows before the stream head
+  void streamTo(uint16_t y) {
+    int32_t top = (int32_t)yMax * SAMPLE_SCALE;
     
-    float* temp = (float*)malloc(dataLen * sizeof(float));
-    if (!temp) return;
-    
-    int16_t half = window / 2;
-    
-    for (uint16_t i = 0; i < dataLen; i++) {
-      float sum = 0;
-      uint16_t count = 0;
-      
-      for (int16_t j = i - half; j <= i + half; j++) {
-        if (j >= 0 && j < dataLen) {
-          sum += data[j];
-          count++;
-        }
+    while (nextRow <= y) {
+      for (uint8_t s = 0; s < seriesCount; s++) {
+        int16_t lo = 0;
+        int16_t hi = 0;
+        series[s].reducer.next(lo, hi);
+        lo = constrain(lo, 0, top);
+        hi = constrain(hi, 0, top);
+        
+        // Map values to x positions
+        series[s].historyLo[nextRow % CURVE_HISTORY] = graphStartX + (((uint32_t)lo * scaleQ16) >> 16);
+        series[s].history[nextRow % CURVE_HISTORY] = graphStartX + (((uint32_t)hi * scaleQ16) >> 16);
       }
-      
-      temp[i] = sum / count;
+      nextRow++;
     }
+  }
+  
+  // X position of series s at a streamed graph row
+  int16_t curvePoint(uint8_t s, uint16_t y) const {
+    return series[s].history[y % CURVE_HISTORY];
+  }
+  
+  bool checkSeriesCount(uint8_t count) const {
+    if (count > 0 && count <= GRAPH_MAX_SERIES) return true;
+    Serial.printf("  ✗ %d series (1..%d supported)!\n", count, GRAPH_MAX_SERIES);
+    return false;
+  }
+  
+  uint8_t lineThickness(uint8_t s, uint8_t thickness) const {
+    return series[s].style.thickness ? series[s].style.thickness : thickness;
+  }
+  
+  // REDUCE_ENVELOPE: fill the min..max span of series s at graph row y,
+  // stretched to touch the previous row's span so the band stays connected
+  void drawEnvelopeRow(uint8_t s, int16_t y, uint8_t thickness) {
+    int16_t pageY = graphStartY + y;
+    if (series[s].style.style == LINE_DASHED && (pageY & LINE_DASH_ROWS)) return;
     
-    memcpy(data, temp, dataLen * sizeof(float));
-    free(temp);
+    int16_t x0 = series[s].historyLo[y % CURVE_HISTORY];
+    int16_t x1 = series[s].history[y % CURVE_HISTORY];
+    if (y > 0) {
+      int16_t prevLo = series[s].historyLo[(y - 1) % CURVE_HISTORY];
+      int16_t prevHi = series[s].history[(y - 1) % CURVE_HISTORY];
+      if (x0 > prevHi + 1) x0 = prevHi + 1;
+      if (x1 < prevLo - 1) x1 = prevLo - 1;
+    }
+    int16_t half = lineThickness(s, thickness) / 2;
+    canvas->fillSpan(pageY, x0 - half, x1 + half + 1);
   }
 
 public:
-  GraphGenerator(BitmapCanvas* cnv, uint16_t w, uint16_t h,
+  BasicGraphGenerator(Canvas* cnv, uint16_t w, uint16_t h,
                  uint16_t lm, uint16_t tm,
                  uint16_t xmax, uint16_t xstp,
                  uint16_t ymax, uint16_t ystp,
@@ -77,18 +245,47 @@ public:
       leftMargin(lm), topMargin(tm),
       xMax(xmax), xStep(xstp),
       yMax(ymax), yStep(ystp),
-      gridXSpacing(gridX), gridYSpacing(gridY)
+      gridXSpacing(gridX), gridYSpacing(gridY),
+      seriesCount(0), curveLen(0), nextRow(0), reduction(REDUCE_MAX)
   {
     graphWidth = gridYSpacing * (yMax / yStep);
     graphStartX = leftMargin;
     graphStartY = topMargin;
     
+    // Rounded so full scale lands exactly on the last grid line
+    uint32_t top = (uint32_t)yMax * SAMPLE_SCALE;
+    scaleQ16 = top ? (((uint32_t)graphWidth << 16) + top / 2) / top : 0;
+    
     // Initialize random seed
     randSeed = micros();
   }
   
+  // Geometry from a GraphLayout
+  template <class Layout>
+  BasicGraphGenerator(Canvas* cnv, Layout)
+    : BasicGraphGenerator(cnv, Layout::WIDTH, Layout::HEIGHT,
+                          Layout::LEFT_MARGIN, Layout::TOP_MARGIN,
+                          Layout::X_MAX, Layout::X_STEP,
+                          Layout::Y_MAX, Layout::Y_STEP,
+                          Layout::GRID_X_SPACING, Layout::GRID_Y_SPACING) {}
+  
+  ~BasicGraphGenerator() {
+    releaseCurve();
+  }
+  
+  // Retarget drawing to another canvas (e.g. the next band buffer)
+  void setCanvas(Canvas* cnv) {
+    canvas = cnv;
+  }
+  
+  // Static layers below draw on the bound canvas, or on any other canvas
+  // passed in (e.g. a BackgroundCache layer)
+  
   // Draw Y-axis labels (Pressure - horizontal across top)
-  void drawYAxisLabels() {
+  void drawYAxisLabels() { drawYAxisLabels(*canvas); }
+  
+  template <class Target>
+  void drawYAxisLabels(Target& target) {
     uint16_t numYDiv = yMax / yStep;
     
     for (uint16_t i = 0; i <= numYDiv; i++) {
@@ -98,19 +295,22 @@ public:
       if (value > 0) {
         char label[8];
         sprintf(label, "%dK", value);
-        canvas->drawText(label, xPos - 13, 5, 2, true);  // Rotated 90°
+        target.drawText(label, xPos - 13, 5, 2, true);  // Rotated 90°
       }
     }
   }
   
   // Draw grid lines
-  void drawGrid(bool dashed = true) {
+  void drawGrid(bool dashed = true) { drawGrid(*canvas, dashed); }
+  
+  template <class Target>
+  void drawGrid(Target& target, bool dashed) {
     // Horizontal grid lines (time divisions)
     uint16_t numXDiv = xMax / xStep;
     for (uint16_t i = 0; i <= numXDiv; i++) {
       int16_t yPos = graphStartY + i * gridXSpacing;
       if (yPos < height + topMargin) {
-        canvas->drawHorizontalLine(yPos, graphStartX, graphStartX + graphWidth, dashed);
+        target.drawHorizontalLine(yPos, graphStartX, graphStartX + graphWidth, dashed);
       }
     }
     
@@ -118,12 +318,15 @@ public:
     uint16_t numYDiv = yMax / yStep;
     for (uint16_t i = 0; i <= numYDiv; i++) {
       int16_t xPos = graphStartX + i * gridYSpacing;
-      canvas->drawVerticalLine(xPos, graphStartY, height + topMargin, dashed);
+      target.drawVerticalLine(xPos, graphStartY, height + topMargin, dashed);
     }
   }
   
   // Draw X-axis labels (Time - vertical along left side)
-  void drawXAxisLabels() {
+  void drawXAxisLabels() { drawXAxisLabels(*canvas); }
+  
+  template <class Target>
+  void drawXAxisLabels(Target& target) {
     uint16_t numXDiv = xMax / xStep;
     
     for (uint16_t i = 0; i <= numXDiv; i++) {
@@ -133,144 +336,225 @@ public:
       if (yPos < height + topMargin - 10) {
         char label[4];
         sprintf(label, "%d", value);
-        canvas->drawText(label, 10, yPos - 3, 2, true);  // Rotated 90°
+        target.drawText(label, 10, yPos - 3, 2, true);  // Rotated 90°
       }
     }
   }
   
   // Draw bottom label
-  void drawBottomLabel() {
-    canvas->drawText("TIME", width / 2 - 15, height + topMargin + 5, 1, true);
+  void drawBottomLabel() { drawBottomLabel(*canvas); }
+  
+  template <class Target>
+  void drawBottomLabel(Target& target) {
+    target.drawText("TIME", width / 2 - 15, height + topMargin + 5, 1, true);
   }
   
-  // Generate build-up curve data
+  // Every layer that does not depend on the curve data
+  template <class Target>
+  void drawBackground(Target& target, bool dashed = true) {
+    drawYAxisLabels(target);
+    drawGrid(target, dashed);
+    drawXAxisLabels(target);
+    drawBottomLabel(target);
+  }
+  
+  // FNV-1a hash of everything the background depends on
+  uint32_t layoutKey(bool dashed) const {
+    const uint16_t params[] = {
+      width, height, leftMargin, topMargin, xMax, xStep, yMax, yStep,
+      gridXSpacing, gridYSpacing, (uint16_t)dashed
+    };
+    
+    uint32_t hash = 2166136261u;
+    const uint8_t* bytes = (const uint8_t*)params;
+    for (size_t i = 0; i < sizeof(params); i++) {
+      hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+  }
+  
+  // Generate build-up curve samples (1/SAMPLE_SCALE units) into a heap buffer
   // pattern: 1 = Quadratic, 2 = Linear with noise
-  float* generateBuildUpCurve(uint16_t numPoints, uint8_t pattern = 1) {
-    float* data = (float*)malloc(numPoints * sizeof(float));
+  // (prefer streaming a BuildUpSource through prepareCurve())
+  int16_t* generateBuildUpCurve(uint32_t numPoints, uint8_t pattern = 1) {
+    BuildUpSource source(numPoints, pattern, yMax, randSeed);
+    if (!source.isValid()) {
+      Serial.printf("  ✗ Invalid pattern %d!\n", pattern);
+      return nullptr;
+    }
+    
+    int16_t* data = (int16_t*)malloc(numPoints * sizeof(int16_t));
     if (!data) {
       Serial.println("  ✗ Failed to allocate curve data!");
       return nullptr;
     }
     
-    // Calculate rise time: 26 seconds out of 30 (86.7%)
-    uint16_t risePoints = (numPoints * 26) / 30;
+    for (uint32_t i = 0; i < numPoints; i++) {
+      data[i] = source.next();
+    }
+    randSeed = source.rngState();  // Next call continues the sequence
     
-    if (pattern == 1) {
-      // ═══════════════════════════════════════════════════════════
-      // PATTERN 1: Quadratic build-up (smooth acceleration)
-      // ═══════════════════════════════════════════════════════════
-      
-      for (uint16_t i = 0; i < risePoints; i++) {
-        float progress = (float)i / risePoints;
-        float baseValue = yMax * (progress * progress);  // Quadratic
-        float noise = random_float(-3.0, 3.0);
-        data[i] = constrain(baseValue + noise, 0, yMax);
-      }
-      
-      // Sudden drop to 0
-      for (uint16_t i = risePoints; i < numPoints; i++) {
-        data[i] = 0;
-      }
-      
-    } else if (pattern == 2) {
-      // ═══════════════════════════════════════════════════════════
-      // PATTERN 2: Linear with noise (steady rise)
-      // ═══════════════════════════════════════════════════════════
-      
-      for (uint16_t i = 0; i < risePoints; i++) {
-        float progress = (float)i / risePoints;
-        float baseValue = yMax * progress;  // Linear
-        float noise = random_float(-8.0, 8.0);
-        data[i] = constrain(baseValue + noise, 0, yMax);
-      }
-      
-      // Sudden drop to 0
-      for (uint16_t i = risePoints; i < numPoints; i++) {
-        data[i] = 0;
+    Serial.printf("  ✓ Generated %lu data points (Pattern %d)\n", (unsigned long)numPoints, pattern);
+    return data;
+  }
+  
+  // Bind the curve source. Samples are reduced to one value (or span) per
+  // graph row as they stream in - see setReduction(); nothing is buffered,
+  // so the source must stay alive until drawing is done.
+  bool prepareCurve(SampleSource& source) {
+    SampleSource* sources[] = {&source};
+    return prepareSeries(sources, 1);
+  }
+  
+  // Same for samples already in memory (not copied: keep rawData alive)
+  bool prepareCurve(const int16_t* rawData, uint32_t dataLen) {
+    return prepareSeries(rawData, dataLen, 1);
+  }
+  
+  // Bind up to GRAPH_MAX_SERIES curves on the same axes (e.g. pressure
+  // and temperature). All are reduced in one pass over the graph rows and
+  // drawn in the same pass over each band, so a band costs one stream
+  // step per row plus one span per series and scanline - not one full
+  // render per series. styles may be nullptr: all solid at the
+  // drawPreparedCurve() thickness.
+  bool prepareSeries(SampleSource* const* sources, uint8_t count,
+                     const SeriesStyle* styles = nullptr) {
+    releaseCurve();
+    if (!checkSeriesCount(count)) return false;
+    for (uint8_t s = 0; s < count; s++) {
+      if (!sources[s] || sources[s]->length() == 0) {
+        Serial.println("  ✗ Invalid curve data!");
+        return false;
       }
-      
-    } else {
-      Serial.printf("  ✗ Invalid pattern %d!\n", pattern);
-      free(data);
-      return nullptr;
     }
     
-    Serial.printf("  ✓ Generated %d data points (Pattern %d)\n", numPoints, pattern);
-    return data;
+    for (uint8_t s = 0; s < count; s++) {
+      series[s].source = sources[s];
+      series[s].style = styles ? styles[s] : SeriesStyle{0, LINE_SOLID};
+    }
+    seriesCount = count;
+    curveLen = height - graphStartY;
+    rewindCurve();
+    return true;
   }
   
-  // Draw curve on canvas
-  void drawCurve(const float* rawData, uint16_t dataLen, uint8_t thickness = 1) {
-    if (!rawData || !canvas || dataLen == 0) {
-      Serial.println("  ✗ Invalid curve data!");
-      return;
+  // Interleaved samples in memory (row 0 of every channel, then row 1...):
+  // points per channel, channel c drawn as series c. Not copied.
+  bool prepareSeries(const int16_t* interleaved, uint32_t points, uint8_t count,
+                     const SeriesStyle* styles = nullptr) {
+    if (!checkSeriesCount(count)) return false;
+    
+    SampleSource* sources[GRAPH_MAX_SERIES];
+    for (uint8_t s = 0; s < count; s++) {
+      series[s].buffer = BufferSource(interleaved ? interleaved + s : nullptr, points, count);
+      sources[s] = &series[s].buffer;
+    }
+    return prepareSeries(sources, count, styles);
+  }
+  
+  uint8_t getSeriesCount() const { return seriesCount; }
+  
+  // How samples are reduced to graph rows (applies from the next
+  // prepareCurve() / prepareSeries()):
+  //   REDUCE_MAX       bucket maximum, smoothed (default)
+  //   REDUCE_ENVELOPE  bucket min..max as one filled span per row; with an
+  //                    IndexedSource (SampleIndex.h) buckets are index queries
+  //   REDUCE_LTTB      one real sample per row (peaks and dips both kept)
+  void setReduction(CurveReduction mode) {
+    reduction = mode;
+  }
+  
+  CurveReduction getReduction() const { return (CurveReduction)reduction; }
+  
+  // Job arena for per-job reduction buffers (REDUCE_LTTB candidates);
+  // they fall back to the heap when it is full
+  void setArena(JobArena* jobArena) {
+    for (uint8_t s = 0; s < GRAPH_MAX_SERIES; s++) {
+      series[s].reducer.setArena(jobArena);
     }
+  }
+  
+  // Draw the prepared curves. Only segments that can touch the current
+  // canvas window are rasterised; consecutive windows (bands) continue
+  // the streams, earlier windows restart them.
+  void drawPreparedCurve(uint8_t thickness = 1) {
+    if (!seriesCount || !canvas) return;
+    bool envelope = reduction == REDUCE_ENVELOPE;
     
-    uint16_t graphHeight = height - graphStartY;
+    // The widest line decides which rows reach into the window
+    // (envelope spans only cover their own row)
+    uint8_t widest = 0;
+    for (uint8_t s = 0; s < seriesCount; s++) {
+      widest = max(widest, lineThickness(s, thickness));
+    }
+    int16_t halfThick = widest / 2;
     
-    // Downsample to graph height using max pooling
-    float* processedData = (float*)malloc(graphHeight * sizeof(float));
-    if (!processedData) {
-      Serial.println("  ✗ Failed to allocate processed data!");
-      return;
+    // Graph rows whose segments reach into the window
+    int16_t first = canvas->getOriginY() - graphStartY;
+    int16_t last = first + canvas->getHeight() - 1;
+    if (!envelope) {
+      first -= halfThick + 1;
+      last += halfThick + 1;
     }
+    if (first < 0) first = 0;
+    if (last > (int16_t)curveLen - 1) last = curveLen - 1;
+    if (first > last) return;
     
-    if (dataLen > graphHeight) {
-      float ratio = (float)dataLen / graphHeight;
-      
-      for (uint16_t i = 0; i < graphHeight; i++) {
-        uint16_t start = (uint16_t)(i * ratio);
-        uint16_t end = (uint16_t)((i + 1) * ratio);
-        
-        float maxVal = 0;
-        for (uint16_t j = start; j < end && j < dataLen; j++) {
-          if (rawData[j] > maxVal) {
-            maxVal = rawData[j];
-          }
+    // Envelope rows also join the row before the window
+    if (first - (envelope && first > 0) + CURVE_HISTORY < (int16_t)nextRow) {
+      rewindCurve();
+    }
+    
+    if (envelope) {
+      for (int16_t y = first; y <= last; y++) {
+        streamTo(y);
+        for (uint8_t s = 0; s < seriesCount; s++) {
+          drawEnvelopeRow(s, y, thickness);
         }
-        processedData[i] = maxVal;
-      }
-    } else {
-      // Copy and pad if needed
-      for (uint16_t i = 0; i < dataLen && i < graphHeight; i++) {
-        processedData[i] = rawData[i];
-      }
-      for (uint16_t i = dataLen; i < graphHeight; i++) {
-        processedData[i] = 0;
       }
+      return;
     }
     
-    // Apply smoothing
-    applyMovingAverage(processedData, graphHeight, 11);
-    
-    // Scale factor: pixels per pressure unit
-    float scale = (float)graphWidth / yMax;
-    
-    // Convert to pixel coordinates and draw
-    int16_t prevX = 0, prevY = 0;
-    bool first = true;
+    // One polyline per series and window, advanced together row by row:
+    // shared vertices are walked once and each scanline is filled once
+    ThickPolyline<Canvas> lines[GRAPH_MAX_SERIES];
+    streamTo(first);
+    for (uint8_t s = 0; s < seriesCount; s++) {
+      lines[s].begin(*canvas, lineThickness(s, thickness), series[s].style.style == LINE_DASHED);
+      lines[s].moveTo(curvePoint(s, first), graphStartY + first);
+    }
     
-    for (uint16_t y = 0; y < graphHeight; y++) {
-      float val = constrain(processedData[y], 0, yMax);
-      
-      // Map value to x position
-      int16_t xOffset = (int16_t)(val * scale);
-      int16_t x = graphStartX + xOffset;
-      int16_t yPos = graphStartY + y;
-      
-      if (!first) {
-        canvas->drawLine(prevX, prevY, x, yPos, thickness);
+    for (int16_t y = first + 1; y <= last; y++) {
+      streamTo(y);
+      for (uint8_t s = 0; s < seriesCount; s++) {
+        lines[s].lineTo(curvePoint(s, y), graphStartY + y);
       }
-      
-      prevX = x;
-      prevY = yPos;
-      first = false;
+    }
+    for (uint8_t s = 0; s < seriesCount; s++) {
+      lines[s].finish();
+    }
+  }
+  
+  // Unbind the curve sources
+  void releaseCurve() {
+    seriesCount = 0;
+    curveLen = 0;
+  }
+  
+  // Draw curve on canvas
+  void drawCurve(const int16_t* rawData, uint32_t dataLen, uint8_t thickness = 1) {
+    if (!canvas || !prepareCurve(rawData, dataLen)) {
+      return;
     }
     
-    free(processedData);
+    drawPreparedCurve(thickness);
+    releaseCurve();
     
     Serial.println("  ✓ Curve drawn");
   }
 };
 
+// Generator drawing on heap canvases (runtime-sized layouts)
+typedef BasicGraphGenerator<BitmapCanvas> GraphGenerator;
+
 #endif // GRAPH_GENERATOR_H
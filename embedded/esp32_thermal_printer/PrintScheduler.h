@@ -0,0 +1,330 @@
+/*
+ * PrintScheduler.h
+ * Priority print job scheduler for thermal printer stations
+ * Jobs wait in a small fixed table instead of a FIFO queue: the most
+ * urgent class runs first (FIFO within a class), a duplicate of a job
+ * that is still waiting is merged into it, and jobs can be cancelled
+ * while queued or, at the next band boundary, while printing. Print
+ * tasks can also pull more urgent jobs in between bands of a long page
+ * (see takeAbove()). Wait and total latency are tracked per class.
+ */
+
+#ifndef PRINT_SCHEDULER_H
+#define PRINT_SCHEDULER_H
+
+#include <Arduino.h>
+#include "Stats.h"
+
+// Jobs waiting or running at once
+#define SCHED_MAX_JOBS 16
+
+// Latency histogram: bucket b counts jobs under 2^b ms (last = longer)
+#define SCHED_LATENCY_BUCKETS 18
+
+// Priority classes, most urgent first
+enum JobClass {
+  JOB_CLASS_URGENT = 0,   // Short receipts, may be slotted into a running page
+  JOB_CLASS_NORMAL,
+  JOB_CLASS_BULK,
+  JOB_CLASS_COUNT
+};
+
+static const char* const JOB_CLASS_NAMES[JOB_CLASS_COUNT] = {"urgent", "normal", "bulk"};
+
+// Latency of finished jobs in one class (ms)
+struct LatencyStats {
+  uint32_t jobs;
+  uint32_t merged;          // Submissions coalesced into a waiting job
+  uint32_t cancelled;
+  uint32_t waitSum;         // Submit -> start
+  uint32_t waitMax;
+  uint32_t totalSum;        // Submit -> finish
+  uint32_t totalMax;
+  uint16_t totalBuckets[SCHED_LATENCY_BUCKETS];
+
+  // Upper bound of the pct-th percentile of total latency (ms)
+  uint32_t percentile(uint8_t pct) const {
+    if (jobs == 0) return 0;
+    uint32_t wanted = ((uint32_t)jobs * pct + 99) / 100;
+    uint32_t seen = 0;
+    for (uint8_t b = 0; b < SCHED_LATENCY_BUCKETS - 1; b++) {
+      seen += totalBuckets[b];
+      if (seen >= wanted) return min((uint32_t)1 << b, totalMax);
+    }
+    return totalMax;
+  }
+};
+
+template <class Job>
+class PrintScheduler {
+private:
+  enum EntryState {
+    ENTRY_FREE = 0,
+    ENTRY_QUEUED,
+    ENTRY_RUNNING
+  };
+
+  struct Entry {
+    Job job;
+    uint32_t id;
+    uint32_t key;           // Coalescing key (0 = never merged)
+    uint32_t submittedAt;   // millis()
+    uint32_t startedAt;
+    uint32_t sequence;      // Submission order within the table
+    uint8_t cls;
+    uint8_t state;
+    bool cancelRequested;
+  };
+
+  Entry entries[SCHED_MAX_JOBS];
+  LatencyStats stats[JOB_CLASS_COUNT];
+  uint32_t nextId;
+  uint32_t nextSequence;
+
+  SemaphoreHandle_t lock;
+  QueueHandle_t wakeups;    // One token per submitted job (may go stale)
+
+  Entry* find(uint32_t id) {
+    for (uint8_t i = 0; i < SCHED_MAX_JOBS; i++) {
+      if (entries[i].state != ENTRY_FREE && entries[i].id == id) return &entries[i];
+    }
+    return nullptr;
+  }
+
+  // Most urgent waiting job of class < below, oldest first (lock held)
+  Entry* best(uint8_t below) {
+    Entry* pick = nullptr;
+    for (uint8_t i = 0; i < SCHED_MAX_JOBS; i++) {
+      Entry& e = entries[i];
+      if (e.state != ENTRY_QUEUED || e.cls >= below) continue;
+      if (!pick || e.cls < pick->cls ||
+          (e.cls == pick->cls && e.sequence < pick->sequence)) {
+        pick = &e;
+      }
+    }
+    return pick;
+  }
+
+  // Hand out a waiting job (lock held)
+  void start(Entry* e, Job& out, uint32_t& id) {
+    e->state = ENTRY_RUNNING;
+    e->startedAt = millis();
+
+    uint32_t wait = e->startedAt - e->submittedAt;
+    LatencyStats& s = stats[e->cls];
+    s.waitSum += wait;
+    if (wait > s.waitMax) s.waitMax = wait;
+    STATS_ADD(STAT_QUEUE_WAIT, wait * 1000);
+
+    out = e->job;
+    id = e->id;
+  }
+
+public:
+  PrintScheduler() : nextId(1), nextSequence(0) {
+    memset(entries, 0, sizeof(entries));
+    memset(stats, 0, sizeof(stats));
+    lock = xSemaphoreCreateMutex();
+    wakeups = xQueueCreate(SCHED_MAX_JOBS, sizeof(uint8_t));
+  }
+
+  ~PrintScheduler() {
+    if (lock) vSemaphoreDelete(lock);
+    if (wakeups) vQueueDelete(wakeups);
+  }
+
+  bool isValid() const { return lock && wakeups; }
+
+  // Queue a job. A job with the same non-zero key that is still waiting
+  // absorbs it (keeping the more urgent class); merged reports that case.
+  // Returns the job id, or 0 if the table is full.
+  uint32_t submit(const Job& job, uint8_t cls, uint32_t key = 0, bool* merged = nullptr) {
+    if (cls >= JOB_CLASS_COUNT) cls = JOB_CLASS_BULK;
+    if (merged) *merged = false;
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+
+    if (key) {
+      for (uint8_t i = 0; i < SCHED_MAX_JOBS; i++) {
+        Entry& e = entries[i];
+        if (e.state == ENTRY_QUEUED && e.key == key) {
+          if (cls < e.cls) e.cls = cls;
+          stats[cls].merged++;
+          uint32_t id = e.id;
+          xSemaphoreGive(lock);
+          if (merged) *merged = true;
+          return id;
+        }
+      }
+    }
+
+    Entry* slot = nullptr;
+    for (uint8_t i = 0; i < SCHED_MAX_JOBS && !slot; i++) {
+      if (entries[i].state == ENTRY_FREE) slot = &entries[i];
+    }
+    if (!slot) {
+      xSemaphoreGive(lock);
+      return 0;
+    }
+
+    slot->job = job;
+    slot->id = nextId++;
+    if (nextId == 0) nextId = 1;
+    slot->key = key;
+    slot->submittedAt = millis();
+    slot->startedAt = 0;
+    slot->sequence = nextSequence++;
+    slot->cls = cls;
+    slot->state = ENTRY_QUEUED;
+    slot->cancelRequested = false;
+    uint32_t id = slot->id;
+
+    xSemaphoreGive(lock);
+
+    uint8_t token = 0;
+    xQueueSend(wakeups, &token, 0);
+    return id;
+  }
+
+  // Wait for the most urgent job and mark it running
+  bool take(Job& out, uint32_t& id, TickType_t wait = portMAX_DELAY) {
+    uint32_t start = xTaskGetTickCount();
+
+    while (true) {
+      uint8_t token;
+      TickType_t elapsed = xTaskGetTickCount() - start;
+      TickType_t left = wait == portMAX_DELAY ? portMAX_DELAY
+                      : (elapsed < wait ? wait - elapsed : 0);
+
+      if (xQueueReceive(wakeups, &token, left) != pdTRUE) return false;
+
+      if (takeAbove(out, id, JOB_CLASS_COUNT)) return true;
+      // Stale token (job cancelled, merged or taken by takeAbove())
+    }
+  }
+
+  // Non-blocking: take a waiting job more urgent than cls, e.g. between
+  // the bands of a running page of that class
+  bool takeAbove(Job& out, uint32_t& id, uint8_t cls) {
+    xSemaphoreTake(lock, portMAX_DELAY);
+    Entry* e = best(cls);
+    if (e) start(e, out, id);
+    xSemaphoreGive(lock);
+    return e != nullptr;
+  }
+
+  // A running job has ended (printed, failed or cancelled)
+  void finish(uint32_t id) {
+    xSemaphoreTake(lock, portMAX_DELAY);
+    Entry* e = find(id);
+    if (e && e->state == ENTRY_RUNNING) {
+      uint32_t total = millis() - e->submittedAt;
+      LatencyStats& s = stats[e->cls];
+
+      if (e->cancelRequested) {
+        s.cancelled++;
+      }
+      s.jobs++;
+      s.totalSum += total;
+      if (total > s.totalMax) s.totalMax = total;
+
+      uint8_t b = 0;
+      while (b < SCHED_LATENCY_BUCKETS - 1 && total >= ((uint32_t)1 << b)) b++;
+      s.totalBuckets[b]++;
+
+      e->state = ENTRY_FREE;
+    }
+    xSemaphoreGive(lock);
+  }
+
+  // Cancel a job. A waiting job is removed and copied to removed (so its
+  // buffers can be released); a running one is flagged for isCancelled().
+  bool cancel(uint32_t id, Job* removed = nullptr, bool* wasRunning = nullptr) {
+    xSemaphoreTake(lock, portMAX_DELAY);
+    Entry* e = find(id);
+    bool found = e != nullptr;
+
+    if (wasRunning) *wasRunning = found && e->state == ENTRY_RUNNING;
+
+    if (found && e->state == ENTRY_QUEUED) {
+      if (removed) *removed = e->job;
+      stats[e->cls].cancelled++;
+      e->state = ENTRY_FREE;
+    } else if (found) {
+      e->cancelRequested = true;
+    }
+    xSemaphoreGive(lock);
+    return found;
+  }
+
+  // Running job asked to stop (checked at band boundaries)
+  bool isCancelled(uint32_t id) {
+    xSemaphoreTake(lock, portMAX_DELAY);
+    Entry* e = find(id);
+    bool cancelled = e && e->cancelRequested;
+    xSemaphoreGive(lock);
+    return cancelled;
+  }
+
+  // Class of a waiting or running job (JOB_CLASS_COUNT if unknown)
+  uint8_t classOf(uint32_t id) {
+    xSemaphoreTake(lock, portMAX_DELAY);
+    Entry* e = find(id);
+    uint8_t cls = e ? e->cls : (uint8_t)JOB_CLASS_COUNT;
+    xSemaphoreGive(lock);
+    return cls;
+  }
+
+  uint8_t waiting() {
+    xSemaphoreTake(lock, portMAX_DELAY);
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < SCHED_MAX_JOBS; i++) {
+      if (entries[i].state == ENTRY_QUEUED) n++;
+    }
+    xSemaphoreGive(lock);
+    return n;
+  }
+
+  // Copy of one class's latency counters
+  LatencyStats getStats(uint8_t cls) {
+    LatencyStats s;
+    xSemaphoreTake(lock, portMAX_DELAY);
+    s = stats[cls < JOB_CLASS_COUNT ? cls : (uint8_t)JOB_CLASS_BULK];
+    xSemaphoreGive(lock);
+    return s;
+  }
+
+  // Print the job table (id, class, state, age)
+  void printJobs() {
+    xSemaphoreTake(lock, portMAX_DELAY);
+    uint32_t now = millis();
+    uint8_t shown = 0;
+    for (uint8_t i = 0; i < SCHED_MAX_JOBS; i++) {
+      const Entry& e = entries[i];
+      if (e.state == ENTRY_FREE) continue;
+      Serial.printf("  #%lu %-6s %-7s %lu ms\n", (unsigned long)e.id, JOB_CLASS_NAMES[e.cls],
+                    e.state == ENTRY_RUNNING ? (e.cancelRequested ? "cancel" : "running") : "queued",
+                    (unsigned long)(now - e.submittedAt));
+      shown++;
+    }
+    xSemaphoreGive(lock);
+    if (!shown) Serial.println("  (no jobs)");
+  }
+
+  // Print latency per class: mean / max wait, mean / p95 / max total
+  void printStats() {
+    for (uint8_t c = 0; c < JOB_CLASS_COUNT; c++) {
+      LatencyStats s = getStats(c);
+      if (s.jobs == 0 && s.merged == 0 && s.cancelled == 0) continue;
+      uint32_t n = s.jobs ? s.jobs : 1;
+      Serial.printf("  %-6s %lu jobs  wait %lu/%lu ms  total %lu/%lu/%lu ms  merged %lu  cancelled %lu\n",
+                    JOB_CLASS_NAMES[c], (unsigned long)s.jobs,
+                    (unsigned long)(s.waitSum / n), (unsigned long)s.waitMax,
+                    (unsigned long)(s.totalSum / n), (unsigned long)s.percentile(95),
+                    (unsigned long)s.totalMax,
+                    (unsigned long)s.merged, (unsigned long)s.cancelled);
+    }
+  }
+};
+
+#endif // PRINT_SCHEDULER_H
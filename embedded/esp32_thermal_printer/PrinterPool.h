@@ -0,0 +1,74 @@
+/*
+ * PrinterPool.h
+ * Several thermal printers driven as one station
+ * POOL_FANOUT prints every job on all printers: bands are rendered once
+ * and streamed to each UART in parallel (BandPipeline fan-out).
+ * POOL_BALANCE gives each job to the first idle printer: one print task
+ * per printer takes jobs from a shared queue, so throughput grows with
+ * the number of printers.
+ */
+
+#ifndef PRINTER_POOL_H
+#define PRINTER_POOL_H
+
+#include <Arduino.h>
+#include "ThermalPrinter.h"
+#include "BandRenderer.h"
+#include "BandPipeline.h"
+
+enum PoolMode {
+  POOL_FANOUT = 0,   // Every job on every printer
+  POOL_BALANCE       // Each job on one printer, whichever is idle first
+};
+
+class PrinterPool {
+private:
+  ThermalPrinter* printers[PIPELINE_MAX_PORTS];
+  uint8_t count;
+  PoolMode mode;
+
+public:
+  PrinterPool(PoolMode poolMode = POOL_FANOUT) : count(0), mode(poolMode) {
+    for (uint8_t i = 0; i < PIPELINE_MAX_PORTS; i++) {
+      printers[i] = nullptr;
+    }
+  }
+
+  // Add a printer (configured, not yet initialised)
+  bool add(ThermalPrinter* printer) {
+    if (!printer || count >= PIPELINE_MAX_PORTS) return false;
+    printers[count++] = printer;
+    return true;
+  }
+
+  // Initialise every printer; ones that fail are dropped from the pool.
+  // Returns the number of printers left.
+  uint8_t begin(const LinkProfile& profile, uint32_t fallbackBaud) {
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < count; i++) {
+      if (printers[i]->begin(profile, fallbackBaud)) {
+        printers[kept++] = printers[i];
+      } else {
+        Serial.printf("  ✗ Printer %d initialization failed\n", i);
+      }
+    }
+    for (uint8_t i = kept; i < count; i++) {
+      printers[i] = nullptr;
+    }
+    count = kept;
+    return count;
+  }
+
+  // Render the page once and stream it to every printer (fan-out)
+  bool print(BandRenderer& page, BandPipeline& pipeline) {
+    return pipeline.print(page, printers, count);
+  }
+
+  // Getters
+  ThermalPrinter* get(uint8_t i) const { return i < count ? printers[i] : nullptr; }
+  ThermalPrinter* const* getPrinters() const { return printers; }
+  uint8_t getCount() const { return count; }
+  PoolMode getMode() const { return mode; }
+};
+
+#endif // PRINTER_POOL_H
@@ -0,0 +1,186 @@
+/*
+ * SampleFrame.h
+ * Binary framed sample ingestion from the external controller
+ * Frames are read in bulk straight into a caller-owned int16 sample
+ * buffer (no intermediate copy), which prepareCurve() then reads directly.
+ *
+ * Frame layout (little-endian):
+ *   0  4  magic A5 5A 'C' 'V'
+ *   4  1  format (FRAME_FORMAT_INT16 / FRAME_FORMAT_FLOAT)
+ *   5  1  channels (0 or 1 = one curve, up to FRAME_MAX_CHANNELS)
+ *   6  2  point count (1..capacity), all channels together
+ *   8  n  samples (count * 2 or count * 4 bytes)
+ *   8+n 4 CRC32 (IEEE 802.3) over bytes 4 .. 8+n-1
+ *
+ * int16 samples are in 1/SAMPLE_SCALE pressure units and are stored as
+ * received; float samples are converted chunk by chunk while reading.
+ * Several channels are interleaved sample by sample (c0 c1 c0 c1 ...).
+ * The device answers every frame with one FRAME_ACK or FRAME_NAK byte.
+ */
+
+#ifndef SAMPLE_FRAME_H
+#define SAMPLE_FRAME_H
+
+#include <Arduino.h>
+#include "CurveReducer.h"
+
+#define FRAME_MAGIC0 0xA5    // Never occurs in text commands
+#define FRAME_MAGIC1 0x5A
+#define FRAME_MAGIC2 'C'
+#define FRAME_MAGIC3 'V'
+
+#define FRAME_FORMAT_INT16 1
+#define FRAME_FORMAT_FLOAT 2
+#define FRAME_FLOAT_CHUNK  64      // Float samples converted per read
+
+#define FRAME_MAX_CHANNELS 4      // Curves per frame (GRAPH_MAX_SERIES)
+
+#define FRAME_HEADER_SIZE 8
+#define FRAME_CHUNK       1024     // Bytes per bulk read
+#define FRAME_TIMEOUT_MS  500      // Max silence inside a frame
+
+#define FRAME_ACK 0x06
+#define FRAME_NAK 0x15
+
+enum FrameResult {
+  FRAME_OK,
+  FRAME_TIMEOUT,
+  FRAME_BAD_HEADER,
+  FRAME_TOO_LONG,
+  FRAME_BAD_CRC
+};
+
+class SampleFrameReader {
+private:
+  Stream& port;               // Controller UART or a network connection
+
+  // Read exactly len bytes; fails if the line stays silent too long
+  bool readExact(uint8_t* dst, size_t len) {
+    size_t got = 0;
+    while (got < len) {
+      size_t want = min((size_t)FRAME_CHUNK, len - got);
+      size_t n = port.readBytes(dst + got, want);  // Blocks in the driver
+      if (n == 0) return false;
+      got += n;
+    }
+    return true;
+  }
+
+  // Drop the rest of a rejected frame so its payload is not parsed as text
+  void skipToIdle() {
+    uint8_t junk[64];
+    while (port.readBytes(junk, sizeof(junk)) > 0) {}
+  }
+
+  FrameResult readFrame(int16_t* dst, uint16_t capacity, uint16_t& count, uint8_t& channels) {
+    uint8_t header[FRAME_HEADER_SIZE];
+    header[0] = FRAME_MAGIC0;
+    if (!readExact(header + 1, FRAME_HEADER_SIZE - 1)) return FRAME_TIMEOUT;
+
+    if (header[1] != FRAME_MAGIC1 || header[2] != FRAME_MAGIC2 ||
+        header[3] != FRAME_MAGIC3) {
+      return FRAME_BAD_HEADER;
+    }
+
+    uint8_t format = header[4];
+    uint8_t lanes = header[5] ? header[5] : 1;
+    uint16_t points = header[6] | (header[7] << 8);
+    if (format != FRAME_FORMAT_INT16 && format != FRAME_FORMAT_FLOAT) {
+      return FRAME_BAD_HEADER;
+    }
+    if (lanes > FRAME_MAX_CHANNELS || points % lanes) {
+      return FRAME_BAD_HEADER;
+    }
+    if (points == 0 || points > capacity) {
+      return FRAME_TOO_LONG;
+    }
+
+    uint32_t crc = crc32(0, header + 4, FRAME_HEADER_SIZE - 4);
+
+    if (format == FRAME_FORMAT_INT16) {
+      // Payload is the sample buffer's own layout (ESP32 is little-endian)
+      size_t payloadBytes = (size_t)points * sizeof(int16_t);
+      if (!readExact((uint8_t*)dst, payloadBytes)) return FRAME_TIMEOUT;
+      crc = crc32(crc, (const uint8_t*)dst, payloadBytes);
+    } else {
+      float chunk[FRAME_FLOAT_CHUNK];
+      for (uint16_t done = 0; done < points; ) {
+        uint16_t n = min((uint16_t)FRAME_FLOAT_CHUNK, (uint16_t)(points - done));
+        if (!readExact((uint8_t*)chunk, n * sizeof(float))) return FRAME_TIMEOUT;
+        crc = crc32(crc, (const uint8_t*)chunk, n * sizeof(float));
+
+        for (uint16_t k = 0; k < n; k++) {
+          float scaled = chunk[k] * SAMPLE_SCALE;
+          if (scaled != scaled) scaled = 0;  // NaN
+          scaled += scaled >= 0 ? 0.5f : -0.5f;
+          dst[done + k] = (int16_t)constrain(scaled, -32768.0f, 32767.0f);
+        }
+        done += n;
+      }
+    }
+
+    uint8_t trailer[4];
+    if (!readExact(trailer, 4)) return FRAME_TIMEOUT;
+
+    uint32_t expected = trailer[0] | (trailer[1] << 8) | (trailer[2] << 16) |
+                        ((uint32_t)trailer[3] << 24);
+    if (crc != expected) return FRAME_BAD_CRC;
+
+    count = points;
+    channels = lanes;
+    return FRAME_OK;
+  }
+
+public:
+  SampleFrameReader(Stream& stream) : port(stream) {}
+
+  // CRC32 (poly 0xEDB88320), nibble table: 64 bytes, ~1 ms per 19 KB
+  static uint32_t crc32(uint32_t crc, const uint8_t* data, size_t len) {
+    static const uint32_t table[16] = {
+      0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+      0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+      0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+      0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+      crc ^= data[i];
+      crc = (crc >> 4) ^ table[crc & 0x0F];
+      crc = (crc >> 4) ^ table[crc & 0x0F];
+    }
+    return ~crc;
+  }
+
+  // Read the rest of a frame whose first magic byte was already consumed.
+  // Samples land in dst (capacity int16s); on success count is the total
+  // sample count and channels the number of interleaved curves.
+  FrameResult read(int16_t* dst, uint16_t capacity, uint16_t& count, uint8_t* channels = nullptr) {
+    unsigned long savedTimeout = port.getTimeout();
+    port.setTimeout(FRAME_TIMEOUT_MS);
+    uint8_t lanes = 1;
+    FrameResult result = readFrame(dst, capacity, count, lanes);
+    if (channels) *channels = lanes;
+    if (result != FRAME_OK && result != FRAME_TIMEOUT) {
+      skipToIdle();
+    }
+    port.setTimeout(savedTimeout);
+    return result;
+  }
+
+  void ack() { port.write((uint8_t)FRAME_ACK); }
+  void nak() { port.write((uint8_t)FRAME_NAK); }
+
+  static const char* resultName(FrameResult result) {
+    switch (result) {
+      case FRAME_OK:         return "OK";
+      case FRAME_TIMEOUT:    return "timeout";
+      case FRAME_BAD_HEADER: return "bad header";
+      case FRAME_TOO_LONG:   return "too many points";
+      case FRAME_BAD_CRC:    return "CRC mismatch";
+    }
+    return "?";
+  }
+};
+
+#endif // SAMPLE_FRAME_H
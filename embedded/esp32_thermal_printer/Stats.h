@@ -0,0 +1,153 @@
+/*
+ * Stats.h
+ * Hot-path instrumentation for the thermal printer pipeline
+ * Stages are timed with esp_timer (1 us resolution) into per-stage
+ * count / total / max counters; bytes sent and heap low-water marks are
+ * tracked alongside. Counters are shared by all tasks and both cores
+ * (updates take a short spinlock). Build with -DPRINT_STATS=0 to compile
+ * every probe out.
+ */
+
+#ifndef PRINT_STATS_H
+#define PRINT_STATS_H
+
+#include <Arduino.h>
+#include <esp_timer.h>
+
+#ifndef PRINT_STATS
+#define PRINT_STATS 1
+#endif
+
+// Timed stages
+enum StatStage {
+  STAT_CANVAS_ALLOC = 0,  // Canvas / band buffer malloc
+  STAT_BACKGROUND,        // Grid + labels (drawn or copied from the cache)
+  STAT_CURVE,             // Curve rasterisation per band
+  STAT_BAND_RENDER,       // Whole band render (includes the two above)
+  STAT_TRANSMIT,          // Band hand-off to the UART (sendBand)
+  STAT_CMD_DELAY,         // Fixed pacing delays and flushes
+  STAT_STALL,             // Waiting on BUSY, GS r barriers or a full TX ring
+  STAT_QUEUE_WAIT,        // Job submit -> start
+  STAT_STAGE_COUNT
+};
+
+static const char* const STAT_STAGE_NAMES[STAT_STAGE_COUNT] = {
+  "canvas alloc", "background", "curve", "band render",
+  "transmit", "cmd delay", "stall", "queue wait"
+};
+
+struct StageTiming {
+  uint32_t count;
+  uint32_t maxUs;
+  uint64_t totalUs;
+};
+
+class PrintStats {
+private:
+  struct Counters {
+    StageTiming stages[STAT_STAGE_COUNT];
+    uint64_t bytesSent;     // Bytes accepted by the printer UARTs
+    uint32_t resetAt;       // millis() of the last reset
+  };
+
+  static Counters& counters() {
+    static Counters c = {};
+    return c;
+  }
+
+  static portMUX_TYPE* lock() {
+    static portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+    return &mux;
+  }
+
+public:
+  static uint32_t now() { return (uint32_t)esp_timer_get_time(); }
+
+  static void add(StatStage stage, uint32_t us) {
+    portENTER_CRITICAL(lock());
+    StageTiming& t = counters().stages[stage];
+    t.count++;
+    t.totalUs += us;
+    if (us > t.maxUs) t.maxUs = us;
+    portEXIT_CRITICAL(lock());
+  }
+
+  static void addBytes(size_t n) {
+    portENTER_CRITICAL(lock());
+    counters().bytesSent += n;
+    portEXIT_CRITICAL(lock());
+  }
+
+  static StageTiming get(StatStage stage) {
+    portENTER_CRITICAL(lock());
+    StageTiming t = counters().stages[stage];
+    portEXIT_CRITICAL(lock());
+    return t;
+  }
+
+  static uint64_t getBytesSent() {
+    portENTER_CRITICAL(lock());
+    uint64_t n = counters().bytesSent;
+    portEXIT_CRITICAL(lock());
+    return n;
+  }
+
+  static void reset() {
+    portENTER_CRITICAL(lock());
+    memset(&counters(), 0, sizeof(Counters));
+    counters().resetAt = millis();
+    portEXIT_CRITICAL(lock());
+  }
+
+  // Print every stage, the byte counter and heap low-water marks
+  static void print() {
+    Serial.printf("  %-13s %7s %10s %8s %8s\n", "stage", "count", "total ms", "avg us", "max us");
+    for (uint8_t s = 0; s < STAT_STAGE_COUNT; s++) {
+      StageTiming t = get((StatStage)s);
+      Serial.printf("  %-13s %7lu %10lu %8lu %8lu\n", STAT_STAGE_NAMES[s],
+                    (unsigned long)t.count, (unsigned long)(t.totalUs / 1000),
+                    (unsigned long)(t.count ? t.totalUs / t.count : 0),
+                    (unsigned long)t.maxUs);
+    }
+
+    uint32_t seconds = (millis() - counters().resetAt) / 1000;
+    Serial.printf("  Bytes sent: %lu over %lu s\n",
+                  (unsigned long)getBytesSent(), (unsigned long)seconds);
+    Serial.printf("  Heap: %lu free, %lu lowest, %lu largest block\n",
+                  (unsigned long)ESP.getFreeHeap(), (unsigned long)ESP.getMinFreeHeap(),
+                  (unsigned long)ESP.getMaxAllocHeap());
+    if (ESP.getPsramSize()) {
+      Serial.printf("  PSRAM: %lu free, %lu lowest\n",
+                    (unsigned long)ESP.getFreePsram(), (unsigned long)ESP.getMinFreePsram());
+    }
+  }
+};
+
+#if PRINT_STATS
+
+// Times the rest of the enclosing scope into one stage
+class StatTimer {
+private:
+  StatStage stage;
+  uint32_t start;
+
+public:
+  StatTimer(StatStage s) : stage(s), start(PrintStats::now()) {}
+  ~StatTimer() { PrintStats::add(stage, PrintStats::now() - start); }
+};
+
+#define STATS_CONCAT2(a, b) a##b
+#define STATS_CONCAT(a, b) STATS_CONCAT2(a, b)
+#define STATS_SCOPE(stage) StatTimer STATS_CONCAT(statTimer, __LINE__)(stage)
+#define STATS_ADD(stage, us) PrintStats::add(stage, us)
+#define STATS_BYTES(n) PrintStats::addBytes(n)
+
+#else
+
+#define STATS_SCOPE(stage) do {} while (0)
+#define STATS_ADD(stage, us) do {} while (0)
+#define STATS_BYTES(n) do {} while (0)
+
+#endif // PRINT_STATS
+
+#endif // PRINT_STATS_H
@@ -9,10 +9,75 @@
 
 #include <Arduino.h>
 #include <HardwareSerial.h>
+#include <driver/uart.h>
+#include <Preferences.h>
+#include "JobStream.h"
+#include "Stats.h"
 
 // ESC/POS Command bytes
 #define ESC 0x1B
 #define GS  0x1D
+#define DLE 0x10
+#define EOT 0x04
+
+// Flow-control pacing tuning
+#define PACING_SLOW_COMMAND_MS 100   // Fixed delays >= this mark mechanical commands
+#define PACING_POLL_WINDOW     2048  // Max unacknowledged bytes in STATUS_POLL mode
+#define PACING_POLL_TIMEOUT_MS 2000  // GS r reply timeout before falling back
+#define PACING_BUSY_TIMEOUT_MS 5000  // Max time to wait on the BUSY line
+#define PACING_BUSY_SLICE      64    // Bytes written between BUSY line checks
+#define PACING_ASB_TIMEOUT_MS  500   // First automatic status after GS a
+#define PACING_ASB_PAUSE_MS    120000  // Max pause (cover open, paper end) before failing
+#define PACING_XON_THRESH      32    // Own RX FIFO levels for XON / XOFF to the printer
+#define PACING_XOFF_THRESH     100
+
+// Automatic status back (GS a): 4 status bytes, byte 1 in the low byte
+#define ASB_OFFLINE        0x00000008u
+#define ASB_COVER_OPEN     0x00000020u
+#define ASB_FEED_BUTTON    0x00000040u   // Paper fed by the FEED button
+#define ASB_MECH_ERROR     0x00000400u
+#define ASB_CUTTER_ERROR   0x00000800u
+#define ASB_UNRECOVERABLE  0x00002000u
+#define ASB_AUTO_RECOVER   0x00004000u   // Clears by itself (e.g. head too hot)
+#define ASB_PAPER_NEAR_END 0x00030000u
+#define ASB_PAPER_END      0x000C0000u
+
+// Baud negotiation
+#define LINK_NVS_NAMESPACE "printer"  // NVS namespace for the negotiated rate
+#define LINK_NVS_KEY       "baud"
+#define LINK_SETTLE_MS     20         // Line settle time after a rate change
+#define LINK_PROBE_TIMEOUT 100        // Status reply timeout per probe (ms)
+
+// Default ESC J motion units per raster row (see setRasterCompression)
+#define RASTER_FEED_UNITS 2
+
+// GS v 0 raster modes: a doubled axis prints every bitmap dot as two
+// head dots (half the resolution, half the bitmap for the same paper)
+enum RasterMode {
+  RASTER_NORMAL = 0,
+  RASTER_DOUBLE_WIDTH = 1,
+  RASTER_DOUBLE_HEIGHT = 2,
+  RASTER_QUADRUPLE = 3
+};
+
+// Head geometry and print settings of one printer model (setProfile()).
+// dots is the bitmap width, i.e. the head width over the mode's x scale;
+// rowScale is graph rows per dot row of the 1200-row reference page, so
+// 2 gives curves twice the vertical resolution (and twice the paper).
+struct PrinterProfile {
+  uint16_t dots;            // Bitmap dots per raster row
+  uint8_t rowScale;         // Graph rows per reference row (1 or 2)
+  uint8_t rasterMode;       // RasterMode for GS v 0
+  uint8_t feedUnits;        // ESC J motion units per head dot row
+  uint8_t density;          // setDensity() values
+  uint8_t breakTime;
+};
+
+// 80 mm heads: TM-T88III (512 dots at 180 dpi, 1/360" motion units) and
+// 576-dot 203 dpi models (check their GS P motion units)
+static constexpr PrinterProfile PROFILE_TM_T88III = {512, 1, RASTER_NORMAL, 2, 10, 2};
+static constexpr PrinterProfile PROFILE_80MM_576 = {576, 1, RASTER_NORMAL, 2, 10, 2};
+static constexpr PrinterProfile PROFILE_80MM_576_FINE = {576, 2, RASTER_NORMAL, 2, 10, 2};
 
 // Alignment options
 enum PrintAlign {
@@ -21,35 +86,615 @@ enum PrintAlign {
   ALIGN_RIGHT = 2
 };
 
+// How bytes are paced to the printer
+enum PacingMode {
+  PACING_FIXED_DELAY = 0,  // flush() + fixed delay per command (no flow control)
+  PACING_HW_FLOW,          // UART CTS (and RTS) hardware flow control
+  PACING_DSR_BUSY,         // Poll the printer DSR/BUSY line on a GPIO
+  PACING_STATUS_POLL,      // GS r round trips as a processing barrier
+  PACING_ASB               // XON / XOFF in UART hardware, paused on GS a status
+};
+
+// Serial link profile for begin(): candidate rates are probed fastest
+// first with DLE EOT round trips; the first rate that answers every
+// probe is kept. The printer's own rate is fixed by its DIP switches,
+// so this finds the fastest rate it is actually set to.
+struct LinkProfile {
+  const uint32_t* bauds;   // Candidate rates, fastest first
+  uint8_t numBauds;
+  uint8_t probes;          // Round trips that must all succeed per rate
+  bool persist;            // Save the result in NVS and try it first next boot
+};
+
+// TM-T88III tops out at 38400; some clones accept 115200
+static const uint32_t LINK_BAUDS_DEFAULT[] = {115200, 57600, 38400, 19200, 9600};
+
+// State of an asynchronous bitmap transfer (see printBitmapAsync)
+enum AsyncState {
+  ASYNC_IDLE = 0,   // Nothing in flight, completion callback has run
+  ASYNC_SENDING,    // Still copying from the caller's bitmap
+  ASYNC_DRAINING    // All bytes queued in the UART driver, bitmap reusable
+};
+
+// Called from poll() once an async transfer has left the UART
+typedef void (*PrintDoneCallback)(bool ok, void* ctx);
+
 class ThermalPrinter {
 private:
   HardwareSerial& serial;
+  uart_port_t uartNum;
+  
+  PacingMode pacing;
+  int8_t busyPin;             // DSR/BUSY input (PACING_DSR_BUSY)
+  uint8_t busyLevel;          // Pin level that means "busy"
+  size_t unackedBytes;        // Bytes sent since the last GS r barrier
+  
+  // Automatic status back (PACING_ASB), parsed in the UART event task
+  bool asbEnabled;
+  volatile uint32_t asbStatus;  // Last status (0 = none received yet)
+  uint32_t asbFrame;            // Status being assembled
+  uint8_t asbFill;              // Bytes of asbFrame received
+  SemaphoreHandle_t asbEvent;   // Given on every status received
+  bool paused;                  // A problem is holding the output back
+  uint32_t pausedSince;
+  size_t rasterOwed;            // Bytes of an abandoned GS v 0 strip still due
+  
+  // Raster compression
+  bool skipBlank;             // Send blank rows as ESC J feeds, trim right edge
+  uint8_t feedUnitsPerDot;    // ESC J motion units per raster dot row
+  uint8_t rasterMode;         // GS v 0 m (RasterMode)
+  
+  // Asynchronous transfer state
+  AsyncState asyncState;
+  const uint8_t* asyncData;
+  uint16_t asyncWidthBytes;
+  uint16_t asyncHeight;
+  uint16_t asyncRow;          // Next row to send
+  uint16_t asyncSegEnd;       // End row of the current GS v 0 segment
+  uint16_t asyncSegBytes;     // Bytes sent per row in the current segment
+  uint16_t asyncRowOffset;    // Bytes of asyncRow already sent
+  PrintDoneCallback asyncDone;
+  void* asyncCtx;
+  
+  JobStream* recorder;        // Receives a copy of every byte sent (optional)
+  
+  // One run of raster rows: blank (bytes == 0, sent as a feed) or ink
+  struct RasterSegment {
+    uint16_t rows;
+    uint16_t bytes;   // Bytes per row actually sent
+  };
+  
+  // Bytes up to and including the last non-blank byte of a row
+  static uint16_t usedBytes(const uint8_t* row, uint16_t widthBytes) {
+    while (widthBytes > 0 && row[widthBytes - 1] == 0) {
+      widthBytes--;
+    }
+    return widthBytes;
+  }
+  
+  // Plan the next segment of a raster starting at row
+  RasterSegment nextSegment(const uint8_t* data, uint16_t widthBytes,
+                            uint16_t height, uint16_t row) const {
+    RasterSegment seg = {(uint16_t)(height - row), widthBytes};
+    if (!skipBlank) return seg;
+    
+    const uint8_t* p = data + (size_t)row * widthBytes;
+    uint16_t used = usedBytes(p, widthBytes);
+    uint16_t end = row + 1;
+    
+    if (used == 0) {
+      // Blank run, limited to what one ESC J can feed
+      uint16_t maxRows = 255 / feedUnitsPerDot;
+      p += widthBytes;
+      while (end < height && end - row < maxRows && usedBytes(p, widthBytes) == 0) {
+        end++;
+        p += widthBytes;
+      }
+      seg.bytes = 0;
+    } else {
+      // Ink run up to the next blank row, trimmed to its widest row
+      uint16_t maxUsed = used;
+      p += widthBytes;
+      while (end < height) {
+        used = usedBytes(p, widthBytes);
+        if (used == 0) break;
+        if (used > maxUsed) maxUsed = used;
+        end++;
+        p += widthBytes;
+      }
+      seg.bytes = maxUsed;
+    }
+    
+    seg.rows = end - row;
+    return seg;
+  }
+  
+  // ESC J for a blank run
+  void feedCommand(uint8_t* cmd, uint16_t rows) const {
+    cmd[0] = ESC;
+    cmd[1] = 'J';
+    cmd[2] = (uint8_t)(rows * feedUnitsPerDot);
+  }
+  
+  // Build GS v 0 raster header
+  void rasterHeader(uint8_t* cmd, uint16_t widthBytes, uint16_t height) const {
+    cmd[0] = GS;
+    cmd[1] = 'v';
+    cmd[2] = '0';
+    cmd[3] = rasterMode;
+    cmd[4] = (uint8_t)(widthBytes & 0xFF);
+    cmd[5] = (uint8_t)((widthBytes >> 8) & 0xFF);
+    cmd[6] = (uint8_t)(height & 0xFF);
+    cmd[7] = (uint8_t)((height >> 8) & 0xFF);
+  }
+  
+  // Finish the async transfer and run its callback
+  void finishAsync(bool ok) {
+    PrintDoneCallback cb = asyncDone;
+    void* ctx = asyncCtx;
+    
+    asyncState = ASYNC_IDLE;
+    asyncData = nullptr;
+    asyncDone = nullptr;
+    asyncCtx = nullptr;
+    
+    if (cb) cb(ok, ctx);
+  }
   
-  // Send command with timeout
+  // Drop any pending bytes from the printer
+  void drainInput() {
+    while (serial.available()) {
+      serial.read();
+    }
+  }
+  
+  // UART RX callback (PACING_ASB): collect 4-byte status frames. Byte 1
+  // matches xxx1xx00, bytes 2-4 match 0xx0xxxx; anything else (a stray
+  // XON / XOFF, line noise) restarts the frame.
+  void onStatusBytes() {
+    while (serial.available()) {
+      uint8_t b = serial.read();
+      if ((b & 0x93) == 0x10) {
+        asbFrame = b;
+        asbFill = 1;
+      } else if (asbFill == 0 || (b & 0x90) != 0) {
+        asbFill = 0;
+      } else {
+        asbFrame |= (uint32_t)b << (8 * asbFill++);
+        if (asbFill == 4) {
+          asbStatus = asbFrame;
+          asbFill = 0;
+          xSemaphoreGive(asbEvent);
+        }
+      }
+    }
+  }
+  
+  // GS a n: report drawer, online / offline, errors and paper sensors;
+  // the printer answers with its current status at once
+  void requestStatusBack() {
+    uint8_t cmd[] = {GS, 'a', 0x0F};
+    serial.write(cmd, 3);
+  }
+  
+  // Start the status monitor and hardware XON / XOFF; false when the
+  // printer sends no status (monitor stopped again)
+  bool startStatusBack() {
+    if (!asbEvent) asbEvent = xSemaphoreCreateBinary();
+    asbStatus = 0;
+    asbFill = 0;
+    paused = false;
+    drainInput();
+    
+    uart_set_sw_flow_ctrl(uartNum, true, PACING_XON_THRESH, PACING_XOFF_THRESH);
+    serial.onReceive([this]() { onStatusBytes(); });
+    requestStatusBack();
+    
+    if (xSemaphoreTake(asbEvent, pdMS_TO_TICKS(PACING_ASB_TIMEOUT_MS)) != pdTRUE) {
+      serial.onReceive(nullptr);
+      uart_set_sw_flow_ctrl(uartNum, false, 0, 0);
+      return false;
+    }
+    asbEnabled = true;
+    return true;
+  }
+  
+  // True while the status reports a problem; the pause and the resume are
+  // logged once each. expired: it cannot recover or has lasted too long.
+  bool statusHold(bool& expired) {
+    expired = false;
+    if (!asbEnabled) return false;
+    
+    uint32_t status = asbStatus;
+    const char* problem = statusProblem(status);
+    if (!problem) {
+      if (paused) Serial.println("  ✓ Printer resumed");
+      paused = false;
+      return false;
+    }
+    if (!paused) {
+      paused = true;
+      pausedSince = millis();
+      Serial.printf("  ⚠ Printer paused: %s\n", problem);
+    }
+    expired = (status & ASB_UNRECOVERABLE) || millis() - pausedSince > PACING_ASB_PAUSE_MS;
+    return true;
+  }
+  
+  // Block while the printer reports a problem; false once it expired
+  bool waitWhilePaused() {
+    bool expired;
+    if (!statusHold(expired)) return true;
+    
+    STATS_SCOPE(STAT_STALL);
+    while (statusHold(expired)) {
+      if (expired) return false;
+      xSemaphoreTake(asbEvent, pdMS_TO_TICKS(100));
+    }
+    return true;
+  }
+  
+  // Finish an abandoned GS v 0 strip with blank bytes so the printer
+  // leaves raster mode before anything else is sent
+  void padRaster() {
+    static const uint8_t blank[64] = {0};
+    while (rasterOwed > 0) {
+      size_t n = emit(blank, min(sizeof(blank), rasterOwed));
+      if (n == 0) break;
+      rasterOwed -= n;
+    }
+  }
+  
+  // Bytes of the async strip not sent yet
+  size_t asyncStripLeft() const {
+    if (asyncRow >= asyncSegEnd) return 0;
+    return (size_t)(asyncSegEnd - asyncRow) * asyncSegBytes - asyncRowOffset;
+  }
+  
+  // Block while the printer holds its BUSY line
+  bool waitWhileBusy() {
+    if (busyPin < 0) return true;
+    
+    STATS_SCOPE(STAT_STALL);
+    uint32_t start = millis();
+    while (digitalRead(busyPin) == busyLevel) {
+      if (millis() - start > PACING_BUSY_TIMEOUT_MS) {
+        Serial.println("Warning: Printer BUSY timeout");
+        return false;
+      }
+      delay(1);
+    }
+    return true;
+  }
+  
+  // Write to the UART and record what was accepted
+  size_t emit(const uint8_t* buf, size_t len) {
+    size_t written = serial.write(buf, len);
+    STATS_BYTES(written);
+    if (recorder) recorder->append(buf, written);
+    return written;
+  }
+  
+  // Write raw bytes, honouring the BUSY line when enabled.
+  // An async bitmap still being copied is finished first so the
+  // printer never sees bytes interleaved with raster data.
+  size_t writeBytes(const uint8_t* buf, size_t len) {
+    if (asyncState == ASYNC_SENDING) {
+      STATS_SCOPE(STAT_STALL);
+      while (asyncState == ASYNC_SENDING) {
+        poll();
+        delay(1);
+      }
+    }
+    
+    // Bytes are held between writes, never dropped: a pause inside a
+    // GS v 0 strip resumes it where it stopped
+    if (!waitWhilePaused()) {
+      return 0;
+    }
+    padRaster();
+    
+    if (pacing != PACING_DSR_BUSY) {
+      return emit(buf, len);
+    }
+    
+    // A BUSY timeout (paper out, printer off) ends the write: the caller
+    // sees a short write instead of every slice waiting out the timeout
+    size_t written = 0;
+    while (written < len) {
+      if (!waitWhileBusy()) return written;
+      size_t slice = min((size_t)PACING_BUSY_SLICE, len - written);
+      written += emit(buf + written, slice);
+    }
+    return written;
+  }
+  
+  // Wait until the printer has processed everything sent so far.
+  // GS r is handled in order with print data, so its reply is a barrier.
+  bool syncBarrier(uint32_t timeoutMs = PACING_POLL_TIMEOUT_MS) {
+    STATS_SCOPE(STAT_STALL);
+    drainInput();
+    
+    uint8_t cmd[] = {GS, 'r', 1};
+    serial.write(cmd, 3);
+    
+    uint32_t start = millis();
+    while (!serial.available()) {
+      if (millis() - start > timeoutMs) {
+        return false;
+      }
+      delay(1);
+    }
+    serial.read();
+    unackedBytes = 0;
+    return true;
+  }
+  
+  // Pace after a write of len bytes. fixedMs is the delay used by the
+  // fixed-delay fallback profile.
+  void pace(size_t len, uint16_t fixedMs) {
+    switch (pacing) {
+      case PACING_FIXED_DELAY: {
+        STATS_SCOPE(STAT_CMD_DELAY);
+        serial.flush();
+        delay(fixedMs);
+        break;
+      }
+        
+      case PACING_HW_FLOW:
+      case PACING_DSR_BUSY:
+      case PACING_ASB:
+        // Flow control already held the bytes back while busy
+        break;
+        
+      case PACING_STATUS_POLL:
+        unackedBytes += len;
+        if (fixedMs >= PACING_SLOW_COMMAND_MS || unackedBytes >= PACING_POLL_WINDOW) {
+          if (!syncBarrier()) {
+            Serial.println("Warning: No status reply, using fixed delays");
+            pacing = PACING_FIXED_DELAY;
+            delay(fixedMs);
+          }
+        }
+        break;
+    }
+  }
+  
+  // Send command, then pace
   bool sendCommand(const uint8_t* cmd, size_t len, uint16_t delayMs = 50) {
-    size_t written = serial.write(cmd, len);
-    serial.flush();
-    delay(delayMs);
+    size_t written = writeBytes(cmd, len);
+    pace(written, delayMs);
     return (written == len);
   }
   
   // Send single byte command
   bool sendByte(uint8_t byte, uint16_t delayMs = 10) {
-    serial.write(byte);
-    serial.flush();
-    delay(delayMs);
-    return true;
+    return sendCommand(&byte, 1, delayMs);
   }
 
 public:
-  ThermalPrinter(HardwareSerial& ser) : serial(ser) {}
+  // port: UART number behind ser (used to detect TX completion)
+  ThermalPrinter(HardwareSerial& ser, uart_port_t port = UART_NUM_1)
+    : serial(ser), uartNum(port), pacing(PACING_FIXED_DELAY),
+      busyPin(-1), busyLevel(HIGH), unackedBytes(0),
+      asbEnabled(false), asbStatus(0), asbFrame(0), asbFill(0), asbEvent(nullptr),
+      paused(false), pausedSince(0), rasterOwed(0),
+      skipBlank(false), feedUnitsPerDot(RASTER_FEED_UNITS), rasterMode(RASTER_NORMAL),
+      asyncState(ASYNC_IDLE), asyncData(nullptr), asyncWidthBytes(0), asyncHeight(0),
+      asyncRow(0), asyncSegEnd(0), asyncSegBytes(0), asyncRowOffset(0),
+      asyncDone(nullptr), asyncCtx(nullptr), recorder(nullptr) {}
+  
+  // Raster compression: blank rows become ESC J paper feeds and each
+  // GS v 0 strip is trimmed to its rightmost black byte.
+  // unitsPerDot: ESC J motion units per dot row (TM-T88III: 1/360" units
+  // over 180 dpi rows = 2); 0 keeps the current (profile) value.
+  void setRasterCompression(bool enabled, uint8_t unitsPerDot = 0) {
+    skipBlank = enabled;
+    if (unitsPerDot) feedUnitsPerDot = unitsPerDot;
+  }
+  
+  bool getRasterCompression() const { return skipBlank; }
+  
+  // Raster mode and feed units of a printer model. Bitmaps passed to
+  // printBitmap() are then profile.dots wide; feeds count bitmap rows,
+  // which are two head rows in the double-height modes.
+  void setProfile(const PrinterProfile& profile) {
+    rasterMode = profile.rasterMode & RASTER_QUADRUPLE;
+    uint8_t rowDots = (rasterMode & RASTER_DOUBLE_HEIGHT) ? 2 : 1;
+    feedUnitsPerDot = (profile.feedUnits ? profile.feedUnits : 1) * rowDots;
+  }
+  
+  RasterMode getRasterMode() const { return (RasterMode)rasterMode; }
+  
+  // Density settings of a profile
+  void setDensity(const PrinterProfile& profile) {
+    setDensity(profile.density, profile.breakTime);
+  }
+  
+  // Record every byte sent from now on (commands, text, raster data) into
+  // rec, e.g. a JobStreamCache slot; nullptr stops recording. Status
+  // queries and GS r barriers are not recorded.
+  void setRecorder(JobStream* rec) { recorder = rec; }
+  JobStream* getRecorder() const { return recorder; }
+  
+  // Replay a recorded job as one stream: no rendering, only wire time.
+  // Paced per chunk like raster data; nothing sent is recorded again.
+  bool printStream(const uint8_t* data, size_t len) {
+    const size_t CHUNK_SIZE = 512;
+    JobStream* saved = recorder;
+    recorder = nullptr;
+    
+    size_t sent = 0;
+    while (sent < len) {
+      size_t chunkSize = min(CHUNK_SIZE, len - sent);
+      size_t written = writeBytes(data + sent, chunkSize);
+      pace(written, 10);
+      if (written != chunkSize) {
+        Serial.printf("Warning: Sent %d of %d bytes\n", written, chunkSize);
+        break;
+      }
+      sent += written;
+    }
+    
+    pace(0, 50);
+    recorder = saved;
+    return sent == len;
+  }
+  
+  bool printStream(const JobStream& stream) {
+    return stream.isComplete() && printStream(stream.getData(), stream.getSize());
+  }
+  
+  // Feed paper by raster dot rows (ESC J)
+  void feedDots(uint16_t rows) {
+    uint16_t maxRows = 255 / feedUnitsPerDot;
+    while (rows > 0) {
+      uint16_t n = min(rows, maxRows);
+      uint8_t cmd[3];
+      feedCommand(cmd, n);
+      sendCommand(cmd, 3, 10);
+      rows -= n;
+    }
+  }
+  
+  // Select pacing mode (call before begin()).
+  // pin: CTS input for PACING_HW_FLOW, BUSY/DSR input for PACING_DSR_BUSY.
+  // PACING_ASB needs the printer's RX line and its XON / XOFF handshake
+  // (DIP switch); it is set up by begin().
+  // rtsPin: optional RTS output for PACING_HW_FLOW.
+  bool setPacing(PacingMode mode, int8_t pin = -1, int8_t rtsPin = -1, uint8_t activeLevel = HIGH) {
+    pacing = mode;
+    busyPin = -1;
+    
+    if (mode == PACING_HW_FLOW) {
+      if (pin < 0 || !serial.setPins(-1, -1, pin, rtsPin)) {
+        Serial.println("Warning: CTS pin not set, using fixed delays");
+        pacing = PACING_FIXED_DELAY;
+        return false;
+      }
+      serial.setHwFlowCtrlMode(rtsPin < 0 ? UART_HW_FLOWCTRL_CTS : UART_HW_FLOWCTRL_CTS_RTS);
+    } else if (mode == PACING_DSR_BUSY) {
+      if (pin < 0) {
+        Serial.println("Warning: BUSY pin not set, using fixed delays");
+        pacing = PACING_FIXED_DELAY;
+        return false;
+      }
+      busyPin = pin;
+      busyLevel = activeLevel;
+      pinMode(busyPin, INPUT);
+    }
+    
+    return true;
+  }
+  
+  PacingMode getPacing() const { return pacing; }
+  
+  // Real-time status query: DLE EOT n (n = 1..4).
+  // Answered immediately, even while the print buffer is full. Not
+  // available once PACING_ASB's monitor owns the RX line (getStatusBack).
+  bool queryStatus(uint8_t n, uint8_t& status, uint32_t timeoutMs = 100) {
+    drainInput();
+    
+    uint8_t cmd[] = {DLE, EOT, n};
+    serial.write(cmd, 3);
+    
+    uint32_t start = millis();
+    while (!serial.available()) {
+      if (millis() - start > timeoutMs) {
+        return false;
+      }
+      delay(1);
+    }
+    status = serial.read();
+    return true;
+  }
+  
+  // Block until the printer has processed all data sent so far
+  // (no-op in fixed-delay mode, where delays already cover it)
+  bool waitReady() {
+    serial.flush();
+    
+    switch (pacing) {
+      case PACING_DSR_BUSY:
+        return waitWhileBusy();
+      case PACING_STATUS_POLL:
+        return syncBarrier();
+      case PACING_ASB:
+        return waitWhilePaused();
+      default:
+        return true;
+    }
+  }
+  
+  // Probe one rate: switch the UART and require valid DLE EOT 1 replies
+  bool probeBaud(uint32_t baud, uint8_t probes) {
+    serial.updateBaudRate(baud);
+    delay(LINK_SETTLE_MS);
+    drainInput();
+    
+    for (uint8_t i = 0; i < probes; i++) {
+      uint8_t status;
+      if (!queryStatus(1, status, LINK_PROBE_TIMEOUT)) {
+        return false;
+      }
+      // Printer status: bit 1 and bit 4 fixed at 1, bits 0 and 7 at 0
+      if ((status & 0x93) != 0x12) {
+        return false;
+      }
+    }
+    return true;
+  }
+  
+  // Find the fastest working rate and switch the UART to it.
+  // Returns the selected rate, or 0 (UART left at fallbackBaud).
+  uint32_t negotiateBaud(const LinkProfile& profile, uint32_t fallbackBaud) {
+    Preferences prefs;
+    uint32_t saved = 0;
+    
+    if (profile.persist && prefs.begin(LINK_NVS_NAMESPACE, true)) {
+      saved = prefs.getUInt(LINK_NVS_KEY, 0);
+      prefs.end();
+    }
+    
+    // Last known good rate first
+    if (saved && probeBaud(saved, profile.probes)) {
+      Serial.printf("  ✓ Printer link: %lu baud (saved)\n", (unsigned long)saved);
+      return saved;
+    }
+    
+    for (uint8_t i = 0; i < profile.numBauds; i++) {
+      uint32_t baud = profile.bauds[i];
+      if (baud == saved) continue;
+      
+      if (probeBaud(baud, profile.probes)) {
+        Serial.printf("  ✓ Printer link: %lu baud\n", (unsigned long)baud);
+        
+        if (profile.persist && prefs.begin(LINK_NVS_NAMESPACE, false)) {
+          prefs.putUInt(LINK_NVS_KEY, baud);
+          prefs.end();
+        }
+        return baud;
+      }
+    }
+    
+    Serial.printf("  ✗ No status reply, staying at %lu baud\n", (unsigned long)fallbackBaud);
+    serial.updateBaudRate(fallbackBaud);
+    delay(LINK_SETTLE_MS);
+    return 0;
+  }
+  
+  // Initialize printer, negotiating the link rate first.
+  // fallbackBaud is used when the printer never answers a probe
+  // (e.g. RX not wired).
+  bool begin(const LinkProfile& profile, uint32_t fallbackBaud) {
+    negotiateBaud(profile, fallbackBaud);
+    return begin();
+  }
   
   // Initialize printer
   bool begin() {
     // Clear buffers
-    while (serial.available()) {
-      serial.read();
-    }
+    drainInput();
     
     delay(500);
     
@@ -61,13 +706,40 @@ public:
     
     // Set defaults
     setDefault();
+    
+    if (pacing == PACING_ASB && !asbEnabled && !startStatusBack()) {
+      Serial.println("Warning: No automatic status, using fixed delays");
+      pacing = PACING_FIXED_DELAY;
+    }
     return true;
   }
   
-  // Reset to default settings
+  // Reset to default settings (and re-arm automatic status)
   void setDefault() {
     uint8_t cmd[] = {ESC, '@'};
     sendCommand(cmd, 2, 300);
+    if (asbEnabled) requestStatusBack();
+  }
+  
+  // Last automatic status (PACING_ASB); false before the first one
+  bool getStatusBack(uint32_t& status) const {
+    status = asbStatus;
+    return asbEnabled;
+  }
+  
+  bool isPaused() const { return paused; }
+  
+  // What stops an ASB status from printing (nullptr = ready)
+  static const char* statusProblem(uint32_t status) {
+    if (status & ASB_COVER_OPEN) return "cover open";
+    if (status & ASB_PAPER_END) return "paper end";
+    if (status & ASB_UNRECOVERABLE) return "unrecoverable error";
+    if (status & ASB_CUTTER_ERROR) return "cutter error";
+    if (status & ASB_MECH_ERROR) return "mechanical error";
+    if (status & ASB_AUTO_RECOVER) return "head temperature / voltage";
+    if (status & ASB_FEED_BUTTON) return "paper feed button";
+    if (status & ASB_OFFLINE) return "offline";
+    return nullptr;
   }
   
   // Set print density
@@ -91,10 +763,9 @@ public:
   
   // Print text line
   void println(const char* text = "") {
-    serial.print(text);
-    serial.write('\n');
-    serial.flush();
-    delay(10);
+    size_t len = writeBytes((const uint8_t*)text, strlen(text));
+    len += writeBytes((const uint8_t*)"\n", 1);
+    pace(len, 10);
   }
   
   // Set text alignment
@@ -117,50 +788,214 @@ public:
   
   // Print bitmap image
   bool printBitmap(uint16_t width, uint16_t height, const uint8_t* bitmapData) {
-    uint16_t widthBytes = width / 8;
-    
-    // GS v 0 - Print raster bitmap
-    uint8_t cmd[] = {
-      GS, 'v', '0',
-      0x00,  // Normal mode
-      (uint8_t)(widthBytes & 0xFF),
-      (uint8_t)((widthBytes >> 8) & 0xFF),
-      (uint8_t)(height & 0xFF),
-      (uint8_t)((height >> 8) & 0xFF)
-    };
-    
-    if (!sendCommand(cmd, 8, 20)) {
-      return false;
-    }
+    uint16_t widthBytes = (width + 7) / 8;   // Rows padded to whole bytes
     
     // Send bitmap data in chunks
     const size_t CHUNK_SIZE = 512;  // Smaller chunks for ESP32
-    size_t totalBytes = widthBytes * height;
-    size_t sent = 0;
+    size_t totalBytes = (size_t)widthBytes * height;
+    uint16_t row = 0;
     
-    while (sent < totalBytes) {
-      size_t chunkSize = min(CHUNK_SIZE, totalBytes - sent);
-      size_t written = serial.write(bitmapData + sent, chunkSize);
+    while (row < height) {
+      RasterSegment seg = nextSegment(bitmapData, widthBytes, height, row);
       
-      if (written != chunkSize) {
-        Serial.printf("Warning: Sent %d of %d bytes\n", written, chunkSize);
+      if (seg.bytes == 0) {
+        feedDots(seg.rows);
+        row += seg.rows;
+        continue;
       }
       
-      sent += written;
-      serial.flush();
+      // GS v 0 - Print raster bitmap
+      uint8_t cmd[8];
+      rasterHeader(cmd, seg.bytes, seg.rows);
+      
+      if (!sendCommand(cmd, 8, 20)) {
+        return false;
+      }
+      
+      const uint8_t* p = bitmapData + (size_t)row * widthBytes;
+      size_t segBytes = (size_t)seg.bytes * seg.rows;
+      size_t sent = 0;
       
-      // Progress indicator
-      if (sent % 4096 == 0) {
-        Serial.printf("  Progress: %d%%\n", (sent * 100) / totalBytes);
+      while (sent < segBytes) {
+        size_t written;
+        
+        if (seg.bytes == widthBytes) {
+          // Full-width rows are contiguous
+          size_t chunkSize = min(CHUNK_SIZE, segBytes - sent);
+          written = writeBytes(p + sent, chunkSize);
+          
+          if (written != chunkSize) {
+            Serial.printf("Warning: Sent %d of %d bytes\n", written, chunkSize);
+            rasterOwed = segBytes - sent - written;
+            return false;
+          }
+        } else {
+          // Trimmed rows: send the used part of each row
+          written = 0;
+          while (written < CHUNK_SIZE && sent + written < segBytes) {
+            size_t r = (sent + written) / seg.bytes;
+            size_t n = writeBytes(p + r * widthBytes, seg.bytes);
+            written += n;
+            if (n != seg.bytes) {
+              Serial.printf("Warning: Sent %d of %d bytes\n", n, seg.bytes);
+              rasterOwed = segBytes - sent - written;
+              return false;
+            }
+          }
+        }
+        
+        sent += written;
+        
+        // Progress indicator (large bitmaps only; banded callers report their own)
+        size_t done = (size_t)row * widthBytes + (sent / seg.bytes) * widthBytes;
+        if (done % 4096 == 0 && done < totalBytes) {
+          Serial.printf("  Progress: %d%%\n", (done * 100) / totalBytes);
+        }
+        
+        pace(written, 10);  // Small delay between chunks (fixed profile)
       }
       
-      delay(10);  // Small delay between chunks
+      row += seg.rows;
     }
     
-    delay(50);
+    pace(0, 50);
     return true;
   }
   
+  // Start a non-blocking bitmap transfer. The bytes are fed to the UART
+  // driver's TX ring buffer from poll(), so the wire carries back-to-back
+  // bytes while the CPU is free. bitmapData must stay valid until poll()
+  // stops returning ASYNC_SENDING. Give the port a large TX buffer
+  // (HardwareSerial::setTxBufferSize before begin) for best results.
+  // Fixed-delay pacing is not applied to async transfers.
+  bool printBitmapAsync(uint16_t width, uint16_t height, const uint8_t* bitmapData,
+                        PrintDoneCallback done = nullptr, void* ctx = nullptr) {
+    if (asyncState == ASYNC_SENDING) {
+      return false;
+    }
+    // Bands start only while the printer is ready
+    if (!waitWhilePaused()) {
+      return false;
+    }
+    padRaster();
+    if (asyncState == ASYNC_DRAINING) {
+      // Previous bytes are already queued ahead of ours
+      finishAsync(true);
+    }
+    
+    asyncData = bitmapData;
+    asyncWidthBytes = (width + 7) / 8;
+    asyncHeight = height;
+    asyncRow = 0;
+    asyncSegEnd = 0;
+    asyncSegBytes = 0;
+    asyncRowOffset = 0;
+    asyncDone = done;
+    asyncCtx = ctx;
+    asyncState = ASYNC_SENDING;
+    
+    poll();
+    return true;
+  }
+  
+  // Advance the async transfer without blocking. Call periodically.
+  AsyncState poll() {
+    if (asyncState == ASYNC_SENDING) {
+      // Respect the BUSY line and a paused printer without waiting on them
+      if (busyPin >= 0 && digitalRead(busyPin) == busyLevel) {
+        return asyncState;
+      }
+      bool expired;
+      if (statusHold(expired)) {
+        if (expired) {
+          rasterOwed = asyncStripLeft();    // Padded once the printer is back
+          finishAsync(false);
+        }
+        return asyncState;
+      }
+      
+      int room = serial.availableForWrite();
+      
+      while (room > 0) {
+        if (asyncRow >= asyncSegEnd) {
+          // Current segment done; plan the next one
+          if (asyncRow >= asyncHeight) {
+            asyncState = ASYNC_DRAINING;
+            asyncData = nullptr;
+            break;
+          }
+          if (room < 8) break;
+          
+          RasterSegment seg = nextSegment(asyncData, asyncWidthBytes, asyncHeight, asyncRow);
+          uint8_t cmd[8];
+          
+          if (seg.bytes == 0) {
+            feedCommand(cmd, seg.rows);
+            room -= emit(cmd, 3);
+            asyncRow += seg.rows;
+            asyncSegEnd = asyncRow;
+          } else {
+            rasterHeader(cmd, seg.bytes, seg.rows);
+            room -= emit(cmd, 8);
+            asyncSegEnd = asyncRow + seg.rows;
+            asyncSegBytes = seg.bytes;
+            asyncRowOffset = 0;
+          }
+          continue;
+        }
+        
+        const uint8_t* p = asyncData + (size_t)asyncRow * asyncWidthBytes + asyncRowOffset;
+        size_t n;
+        
+        if (asyncSegBytes == asyncWidthBytes) {
+          // Full-width rows: send as much of the segment as fits
+          size_t left = (size_t)(asyncSegEnd - asyncRow) * asyncWidthBytes - asyncRowOffset;
+          n = emit(p, min((size_t)room, left));
+          size_t offset = asyncRowOffset + n;
+          asyncRow += offset / asyncWidthBytes;
+          asyncRowOffset = offset % asyncWidthBytes;
+        } else {
+          // Trimmed rows: finish the current row
+          n = emit(p, min((size_t)room, (size_t)(asyncSegBytes - asyncRowOffset)));
+          asyncRowOffset += n;
+          if (asyncRowOffset >= asyncSegBytes) {
+            asyncRow++;
+            asyncRowOffset = 0;
+          }
+        }
+        
+        if (n == 0) break;
+        room -= n;
+      }
+    }
+    
+    if (asyncState == ASYNC_DRAINING) {
+      bool expired;
+      if (uart_wait_tx_done(uartNum, 0) == ESP_OK) {
+        finishAsync(true);
+      } else if (statusHold(expired) && expired) {
+        finishAsync(false);     // Held by XOFF: sent once the printer is back
+      }
+    }
+    
+    return asyncState;
+  }
+  
+  // Abort the async transfer. Bytes already queued are still sent and
+  // the current GS v 0 segment is padded with blank bytes so the printer
+  // leaves raster mode cleanly (this part blocks).
+  void cancelAsync() {
+    if (asyncState == ASYNC_SENDING) {
+      rasterOwed = asyncStripLeft();
+      padRaster();
+    }
+    if (asyncState != ASYNC_IDLE) {
+      finishAsync(false);
+    }
+  }
+  
+  bool isAsyncBusy() const { return asyncState != ASYNC_IDLE; }
+  
   // Feed paper (advance by lines)
   void feed(uint8_t lines = 1) {
     uint8_t cmd[] = {ESC, 'd', lines};
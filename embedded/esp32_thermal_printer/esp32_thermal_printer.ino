@@ -22,6 +22,7 @@
 #include "ThermalPrinter.h"
 #include "BitmapCanvas.h"
 #include "GraphGenerator.h"
+#include "BandRenderer.h"
 
 // ======== LED Configuration ========
 #define LED_PIN     48           // on-board WS2812 data line
@@ -33,15 +34,36 @@ CRGB leds[NUM_LEDS];
 // ======== Serial Configuration ========
 #define PRINTER_TX  17
 #define PRINTER_RX  18
-#define PRINTER_BAUD 19200
+#define PRINTER_BAUD 19200        // Start / fallback rate
+#define PRINTER_TX_BUFFER 8192  // UART TX ring buffer (holds a whole band)
+
+// Link negotiation: candidates are probed fastest first, result kept in NVS
+const LinkProfile PRINTER_LINK = {
+  LINK_BAUDS_DEFAULT,
+  sizeof(LINK_BAUDS_DEFAULT) / sizeof(LINK_BAUDS_DEFAULT[0]),
+  3,      // Status round trips per candidate
+  true    // Persist negotiated rate
+};
+
+// Pacing: PACING_FIXED_DELAY (no flow control), PACING_HW_FLOW (RTS/CTS),
+// PACING_DSR_BUSY (BUSY line on a GPIO), PACING_STATUS_POLL (GS r) or
+// PACING_ASB (XON/XOFF + automatic status: pauses on paper end / cover open)
+#define PRINTER_PACING PACING_FIXED_DELAY
+#define PRINTER_BUSY_PIN -1   // CTS / DSR input from printer (-1 = unused)
+#define PRINTER_RTS_PIN  -1   // RTS output to printer (-1 = unused)
+#define PRINTER_SKIP_BLANK true  // Blank raster rows sent as ESC J feeds
+
+// Head width, raster mode and density: PROFILE_TM_T88III (512 dots),
+// PROFILE_80MM_576 or PROFILE_80MM_576_FINE (576 dots, 2x graph rows)
+#define PRINTER_PROFILE PROFILE_TM_T88III
 
 HardwareSerial PrinterSerial(1);
 
 // ======== Graph Parameters ========
-#define GRAPH_WIDTH  512
-#define GRAPH_HEIGHT 1200
-#define GRID_X_SPACING 80
-#define GRID_Y_SPACING 60
+#define GRAPH_WIDTH  PRINTER_PROFILE.dots
+#define GRAPH_HEIGHT (1200 * PRINTER_PROFILE.rowScale)
+#define GRID_X_SPACING (80 * PRINTER_PROFILE.rowScale)
+#define GRID_Y_SPACING ((GRAPH_WIDTH - 32) / 8)   // 60 at 512 dots
 #define GRID_DASHED true
 
 #define X_MAX 30
@@ -53,8 +75,17 @@ HardwareSerial PrinterSerial(1);
 #define TOP_MARGIN 70
 #define BOTTOM_MARGIN 10
 
+#define BAND_ROWS 64               // Rows rendered per GS v 0 strip
+
+// Paper geometry fixed at compile time
+typedef GraphLayout<GRAPH_WIDTH, GRAPH_HEIGHT, LEFT_MARGIN, TOP_MARGIN, BOTTOM_MARGIN,
+                    X_MAX, X_STEP, Y_MAX, Y_STEP,
+                    GRID_X_SPACING, GRID_Y_SPACING> PageLayout;
+typedef PageLayout::Band<BAND_ROWS> BandCanvas;
+
 // ======== Global Objects ========
 ThermalPrinter* printer = nullptr;
+CANVAS_STORAGE_ATTR BandCanvas bandBuffer;   // Static band buffer, no heap
 
 // ======== LED Status Functions ========
 void setLEDColor(CRGB color) {
@@ -96,6 +127,7 @@ void setup() {
   Serial.println("✓ LED initialized");
   
   // Initialize printer serial
+  PrinterSerial.setTxBufferSize(PRINTER_TX_BUFFER);
   PrinterSerial.begin(PRINTER_BAUD, SERIAL_8N1, PRINTER_RX, PRINTER_TX);
   delay(500);
   Serial.println("✓ Serial port opened");
@@ -103,6 +135,7 @@ void setup() {
   // Print configuration
   Serial.println("\nConfiguration:");
   Serial.printf("  Canvas: %dx%d pixels\n", GRAPH_WIDTH, GRAPH_HEIGHT + TOP_MARGIN + BOTTOM_MARGIN);
+  Serial.printf("  Band: %dx%d pixels (%d bytes)\n", GRAPH_WIDTH, BAND_ROWS, ((GRAPH_WIDTH + 7) / 8) * BAND_ROWS);
   Serial.printf("  Graph area: %dx%d pixels\n", GRID_Y_SPACING * (Y_MAX / Y_STEP), GRAPH_HEIGHT - TOP_MARGIN);
   Serial.printf("  X-axis: 0 to %ds (step %ds)\n", X_MAX, X_STEP);
   Serial.printf("  Y-axis: 0 to %dK (step %dK)\n", Y_MAX, Y_STEP);
@@ -113,6 +146,9 @@ void setup() {
   
   // Create printer instance
   printer = new ThermalPrinter(PrinterSerial);
+  printer->setPacing(PRINTER_PACING, PRINTER_BUSY_PIN, PRINTER_RTS_PIN);
+  printer->setRasterCompression(PRINTER_SKIP_BLANK);
+  printer->setProfile(PRINTER_PROFILE);
   
   // Run the print job
   printGraph();
@@ -123,7 +159,7 @@ void printGraph() {
   indicateProcessing();
   Serial.println("[1/5] Initializing printer...");
   
-  if (!printer->begin()) {
+  if (!printer->begin(PRINTER_LINK, PRINTER_BAUD)) {
     Serial.println("  ✗ Printer initialization failed!");
     indicateFailure();
     return;
@@ -132,64 +168,41 @@ void printGraph() {
   
   // Configure printer
   Serial.println("\n[2/5] Configuring printer...");
-  printer->setDensity(10, 2);
+  printer->setDensity(PRINTER_PROFILE);
   printer->setLineHeight(24);
   Serial.println("  ✓ Configuration applied");
   
   // Generate graph
   Serial.println("\n[3/5] Generating graph...");
   
-  uint16_t totalHeight = GRAPH_HEIGHT + TOP_MARGIN + BOTTOM_MARGIN;
-  BitmapCanvas* canvas = new BitmapCanvas(GRAPH_WIDTH, totalHeight);
+  // Create graph generator (drawing target is bound per band)
+  BasicGraphGenerator<BandCanvas> generator(nullptr, PageLayout());
+  
+  // Stream the curve: samples are generated, reduced and drawn band by
+  // band without ever being buffered
+  Serial.println("  → Streaming build-up curve data...");
+  BuildUpSource curveData(4800, 1, Y_MAX, micros());  // Pattern 1
   
-  if (!canvas) {
-    Serial.println("  ✗ Failed to create canvas!");
+  if (!generator.prepareCurve(curveData)) {
+    Serial.println("  ✗ Failed to prepare curve!");
     indicateFailure();
     return;
   }
   
-  canvas->clear();
-  Serial.println("  ✓ Canvas created");
-  
-  // Create graph generator
-  GraphGenerator generator(canvas, GRAPH_WIDTH, GRAPH_HEIGHT, 
-                          LEFT_MARGIN, TOP_MARGIN,
-                          X_MAX, X_STEP, Y_MAX, Y_STEP,
-                          GRID_X_SPACING, GRID_Y_SPACING);
-  
-  Serial.println("\n[4/5] Drawing graph components...");
-  
-  // Draw Y-axis labels (Pressure)
-  Serial.println("  → Drawing Y-axis labels...");
-  generator.drawYAxisLabels();
+  Serial.println("\n[4/5] Setting up band renderer...");
   
-  // Draw grid
-  Serial.println("  → Drawing grid...");
-  generator.drawGrid(GRID_DASHED);
+  uint16_t totalHeight = PageLayout::PAGE_HEIGHT;
+  BasicBandRenderer<BandCanvas> renderer(generator, GRAPH_WIDTH, totalHeight, BAND_ROWS);
   
-  // Draw X-axis labels (Time)
-  Serial.println("  → Drawing X-axis labels...");
-  generator.drawXAxisLabels();
-  
-  // Generate and draw curve
-  Serial.println("  → Generating build-up curve data...");
-  float* curveData = generator.generateBuildUpCurve(4800, 1);  // Pattern 1
-  
-  if (!curveData) {
-    Serial.println("  ✗ Failed to generate curve data!");
-    delete canvas;
+  if (!renderer.isValid()) {
+    Serial.println("  ✗ Invalid band layout!");
     indicateFailure();
     return;
   }
   
-  Serial.println("  → Drawing curve...");
-  generator.drawCurve(curveData, 4800);
-  free(curveData);
-  
-  // Draw bottom label
-  generator.drawBottomLabel();
-  
-  Serial.println("  ✓ Graph generation complete");
+  renderer.setGridDashed(GRID_DASHED);
+  renderer.setCurveThickness(1);
+  Serial.printf("  ✓ %d bands of %d rows\n", renderer.bandCount(), BAND_ROWS);
   
   // Print to thermal printer
   Serial.println("\n[5/5] Printing to device...");
@@ -199,11 +212,10 @@ void printGraph() {
   printer->feed(8);
   printer->setFontSize(1, 1);
   
-  Serial.printf("  → Sending bitmap (%dx%d)...\n", canvas->getWidth(), canvas->getHeight());
+  Serial.printf("  → Rendering and sending bitmap (%dx%d)...\n", GRAPH_WIDTH, totalHeight);
   
-  if (!printer->printBitmap(canvas->getWidth(), canvas->getHeight(), canvas->getData())) {
+  if (!renderer.print(*printer, bandBuffer)) {
     Serial.println("  ✗ Bitmap transmission failed!");
-    delete canvas;
     indicateFailure();
     return;
   }
@@ -216,8 +228,6 @@ void printGraph() {
   printer->println("PRESSURE");
   printer->feed(3);
   
-  delete canvas;
-  
   Serial.println("\n========================================");
   Serial.println("✓✓✓ PRINTING COMPLETED! ✓✓✓");
   Serial.println("========================================");
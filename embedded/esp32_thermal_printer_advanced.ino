@@ -6,14 +6,32 @@
  *  - FreeRTOS task separation (LED, Communication, Printing)
  *  - Serial command interface
  *  - Thread-safe status updates
- *  - Queue-based print job management
+ *  - Priority print scheduler (merge, cancel, preemption between bands)
+ *  - Dual-core band pipeline (render on core 1, UART on core 0)
+ *  - Reprints replayed from recorded ESC/POS job streams
+ *  - Controller jobs logged to flash, reprinted from memory-mapped flash
+ *  - Wi-Fi: raw port-9100 ESC/POS passthrough and POST /samples
+ *  - Printer pool: one job on several printers, or jobs spread over them
+ *  - Live strip chart: samples printed band by band as they arrive
  */
 
 #include <FastLED.h>
 #include <HardwareSerial.h>
+#include <WiFi.h>
 #include "ThermalPrinter.h"
 #include "BitmapCanvas.h"
 #include "GraphGenerator.h"
+#include "BandRenderer.h"
+#include "BandPipeline.h"
+#include "SampleFrame.h"
+#include "JobStream.h"
+#include "JobLog.h"
+#include "NetPrintServer.h"
+#include "PrinterPool.h"
+#include "PrintScheduler.h"
+#include "StripChart.h"
+#include "JobArena.h"
+#include "Stats.h"
 
 // ======== LED Configuration ========
 #define LED_PIN     48
@@ -23,11 +41,90 @@
 CRGB leds[NUM_LEDS];
 
 // ======== Serial Configuration ========
-#define PRINTER_TX  17
-#define PRINTER_RX  18
-#define PRINTER_BAUD 19200
+#define PRINTER_BAUD 19200        // Start / fallback rate
+#define PRINTER_TX_BUFFER 8192  // UART TX ring buffer (holds a whole band)
 
-HardwareSerial PrinterSerial(1);
+// Link negotiation: candidates are probed fastest first, result kept in NVS
+const LinkProfile PRINTER_LINK = {
+  LINK_BAUDS_DEFAULT,
+  sizeof(LINK_BAUDS_DEFAULT) / sizeof(LINK_BAUDS_DEFAULT[0]),
+  3,      // Status round trips per candidate
+  true    // Persist negotiated rate
+};
+
+// Pacing: PACING_FIXED_DELAY (no flow control), PACING_HW_FLOW (RTS/CTS),
+// PACING_DSR_BUSY (BUSY line on a GPIO), PACING_STATUS_POLL (GS r) or
+// PACING_ASB (XON/XOFF + automatic status: pauses on paper end / cover open)
+#define PRINTER_PACING PACING_FIXED_DELAY
+#define PRINTER_SKIP_BLANK true  // Blank raster rows sent as ESC J feeds
+
+// Head width, raster mode and density: PROFILE_TM_T88III (512 dots),
+// PROFILE_80MM_576 or PROFILE_80MM_576_FINE (576 dots, 2x graph rows)
+#define PRINTER_PROFILE PROFILE_TM_T88III
+
+// Printer ports (UART0 is the controller link, leaving UART1 and UART2)
+struct PrinterPort {
+  uint8_t uart;
+  int8_t tx;
+  int8_t rx;
+  int8_t busyPin;   // CTS / DSR input from printer (-1 = unused)
+  int8_t rtsPin;    // RTS output to printer (-1 = unused)
+};
+
+const PrinterPort PRINTER_PORTS[] = {
+  {1, 17, 18, -1, -1},
+  // {2, 15, 16, -1, -1},   // Second printer
+};
+#define PRINTER_COUNT (sizeof(PRINTER_PORTS) / sizeof(PRINTER_PORTS[0]))
+
+// POOL_FANOUT: every job on every printer (bands rendered once)
+// POOL_BALANCE: each job on the first idle printer (one print task each)
+#define PRINTER_POOL_MODE POOL_FANOUT
+
+// ======== Render Configuration ========
+#define BAND_ROWS 64    // Rows rendered per GS v 0 strip (4 KB band at 512 dots)
+#define PIPELINE_BANDS 2  // Band buffers shared by render and UART tasks
+#define RENDER_CORE 1     // Band rendering core (UART sender runs on core 0)
+
+// Per print task, internal RAM: job-scoped buffers (sequential fallback
+// band, LTTB candidates, live chart band and row ring), released in O(1)
+// after each job
+#define JOB_ARENA_BYTES (8 * 1024)
+
+// Paper geometry from the profile: head width, 1200-row graph (x rowScale),
+// 30/70/10 margins, 0-30 s in 2 s steps, 0-200 K in 25 K steps, 80-row
+// (x rowScale) time grid, pressure grid spread over the head (60 dots at 512)
+#define PAGE_ROW_SCALE PRINTER_PROFILE.rowScale
+typedef GraphLayout<PRINTER_PROFILE.dots, 1200 * PAGE_ROW_SCALE, 30, 70, 10, 30, 2, 200, 25,
+                    80 * PAGE_ROW_SCALE, (PRINTER_PROFILE.dots - 32) / 8> PageLayout;
+
+// ======== Sample Ingestion ========
+// Controller frames arrive on UART0 (USB CDC On Boot must be disabled so
+// Serial is the UART0 HardwareSerial); see SampleFrame.h for the format
+#define CONTROLLER_SERIAL Serial
+#define SERIAL_RX_BUFFER  4096   // UART0 RX ring (bulk frame reads drain it)
+#define SAMPLE_MAX_POINTS 4800   // Largest frame accepted (all channels)
+#define SAMPLE_BUFFERS    (PRINTER_COUNT + 2)  // One per print task + serial and HTTP receivers
+
+// Live strip chart (LIVE command): frames are printed as they arrive.
+// 4 samples per row at 160 Hz is 40 rows/s, the time scale of the page
+// (2 per row on 2x pages).
+#define LIVE_SAMPLES_PER_ROW (4 / PAGE_ROW_SCALE)
+#define LIVE_DEMO_RATE 160        // Samples/s fed by LIVE P1 / LIVE P2
+
+// Multi-channel frames (and PM) overlay one curve per channel on the page
+// axes; line style per channel, thickness 0 = the page's curve thickness
+const SeriesStyle SERIES_STYLES[GRAPH_MAX_SERIES] = {
+  {0, LINE_SOLID}, {0, LINE_DASHED}, {3, LINE_SOLID}, {3, LINE_DASHED}
+};
+
+// ======== Network Configuration ========
+// Line PCs submit over Wi-Fi: raw ESC/POS to port 9100, sample frames to
+// POST /samples (e.g. curl --data-binary @frame.bin http://<ip>/samples).
+// Empty SSID = serial console only.
+#define WIFI_SSID     ""
+#define WIFI_PASSWORD ""
+#define NET_SUBMIT_WAIT_MS 5000   // POSTs wait this long for a buffer / queue slot, then 503
 
 // ======== Status Enumeration ========
 enum SystemStatus {
@@ -41,114 +138,528 @@ enum SystemStatus {
 // ======== Global State ========
 volatile SystemStatus currentStatus = STATUS_IDLE;
 SemaphoreHandle_t statusMutex;
-QueueHandle_t printQueue;
+QueueHandle_t sampleFreeQueue;   // Sample buffers not owned by a job
+
+// Shared by all print tasks
+BackgroundCache* background;     // Grid and labels, rendered once
+JobStreamCache* history;         // Byte streams of the last jobs (R commands)
+SemaphoreHandle_t historyMutex;
+JobLog* jobLog;                  // Controller jobs on flash (LOG, RL commands)
+SemaphoreHandle_t logMutex;      // Held while a logged job is mapped
+
+// One per print task
+struct PrintWorker {
+  PrinterPool* pool;
+  JobArena* arena;
+};
+
+JobArena* arenas[PRINTER_COUNT];
+uint8_t arenaCount = 0;
+
+// Print job kinds
+enum JobKind {
+  JOB_GRAPH,            // Rendered graph (controller data or pattern)
+  JOB_REPRINT,          // Replay of a recorded job
+  JOB_TEXT,             // Short text receipt (description only)
+  JOB_LIVE,             // Strip chart of live samples (pattern = demo)
+  JOB_ARCHIVE,          // Logged job re-rendered from flash
+  JOB_RAW               // ESC/POS bytes of a port-9100 session (rawRing)
+};
 
 // Print job structure
 struct PrintJob {
-  uint8_t pattern;      // 1 or 2
-  uint16_t numPoints;   // Data points
-  char description[32]; // Job description
+  uint8_t kind;         // JobKind
+  uint8_t pattern;      // 1 or 2 (0 = controller samples)
+  uint16_t numPoints;   // Data points (all channels)
+  uint8_t channels;     // Curves on one graph (interleaved in samples)
+  int16_t* samples;     // Controller samples (nullptr = synthetic pattern)
+  uint8_t reprint;      // JOB_REPRINT: replay the n-th last recorded job
+  uint32_t logSeq;      // JOB_ARCHIVE: logged job number (0 = newest)
+  uint8_t reduction;    // CurveReduction of the graph
+  char description[32]; // Job description / receipt text
+};
+
+// Reduction for new graph jobs (set by the REDUCE command)
+CurveReduction curveReduction = REDUCE_MAX;
+
+// Ring of the current port-9100 session (one at a time)
+ByteRing* rawRing = nullptr;
+
+// Waiting and running jobs. Only text receipts are submitted as urgent,
+// so every urgent job can be printed in between the bands of a graph.
+PrintScheduler<PrintJob>* scheduler;
+
+// Controller frames for the running live chart
+struct LiveFrame {
+  int16_t* samples;
+  uint16_t count;
 };
 
+QueueHandle_t liveQueue;
+SemaphoreHandle_t liveMutex;     // Guards liveJobId and sends to liveQueue
+uint32_t liveJobId = 0;          // Live chart taking frames (0 = none)
+
 // ======== LED Task ========
+TaskHandle_t ledTask = nullptr;
+
+// Sleeps until setStatus() posts a new status
 void taskLED(void* param) {
-  SystemStatus lastStatus = STATUS_IDLE;
-  
   while (1) {
-    // Get current status
-    xSemaphoreTake(statusMutex, portMAX_DELAY);
-    SystemStatus status = currentStatus;
-    xSemaphoreGive(statusMutex);
+    uint32_t status;
+    xTaskNotifyWait(0, 0, &status, portMAX_DELAY);
     
-    // Update LED if status changed
-    if (status != lastStatus) {
-      switch (status) {
-        case STATUS_IDLE:
-          leds[0] = CRGB::Black;
-          break;
-        case STATUS_STARTING:
-          leds[0] = CRGB(0, 191, 255);  // Light Blue
-          break;
-        case STATUS_PROCESSING:
-          leds[0] = CRGB(255, 255, 0);  // Yellow
-          break;
-        case STATUS_SUCCESS:
-          leds[0] = CRGB::Green;
-          break;
-        case STATUS_FAILURE:
-          leds[0] = CRGB::Red;
-          break;
-      }
-      FastLED.show();
-      lastStatus = status;
+    switch (status) {
+      case STATUS_IDLE:
+        leds[0] = CRGB::Black;
+        break;
+      case STATUS_STARTING:
+        leds[0] = CRGB(0, 191, 255);  // Light Blue
+        break;
+      case STATUS_PROCESSING:
+        leds[0] = CRGB(255, 255, 0);  // Yellow
+        break;
+      case STATUS_SUCCESS:
+        leds[0] = CRGB::Green;
+        break;
+      case STATUS_FAILURE:
+        leds[0] = CRGB::Red;
+        break;
     }
-    
-    vTaskDelay(pdMS_TO_TICKS(20));
+    FastLED.show();
   }
 }
 
 // ======== Set Status (Thread-Safe) ========
+// Changes are posted to the LED task under the mutex, so it ends on the
+// latest status (overwrite: one it has not shown yet is skipped)
 void setStatus(SystemStatus newStatus) {
   xSemaphoreTake(statusMutex, portMAX_DELAY);
-  currentStatus = newStatus;
+  if (newStatus != currentStatus) {
+    currentStatus = newStatus;
+    xTaskNotify(ledTask, newStatus, eSetValueWithOverwrite);
+  }
   xSemaphoreGive(statusMutex);
 }
 
+// ======== Job Submission ========
+// Hand a controller frame buffer back once its curve has been drawn
+void releaseSamples(PrintJob& job) {
+  if (job.samples) {
+    xQueueSend(sampleFreeQueue, &job.samples, portMAX_DELAY);
+    job.samples = nullptr;
+  }
+}
+
+PrintJob makeJob(JobKind kind, const char* description) {
+  PrintJob job;
+  job.kind = kind;
+  job.pattern = 0;
+  job.numPoints = 0;
+  job.channels = 1;
+  job.samples = nullptr;
+  job.reprint = 0;
+  job.logSeq = 0;
+  job.reduction = curveReduction;
+  strncpy(job.description, description, sizeof(job.description) - 1);
+  job.description[sizeof(job.description) - 1] = '\0';
+  return job;
+}
+
+// Queue a command's job and report the result
+void submitJob(const PrintJob& job, uint8_t cls, uint32_t key, const char* what) {
+  bool merged = false;
+  uint32_t id = scheduler->submit(job, cls, key, &merged);
+  
+  if (id == 0) {
+    Serial.println("✗ Queue full!");
+  } else if (merged) {
+    Serial.printf("✓ %s merged into waiting job #%lu\n", what, (unsigned long)id);
+  } else {
+    Serial.printf("✓ %s queued as job #%lu (%s)\n", what, (unsigned long)id, JOB_CLASS_NAMES[cls]);
+  }
+}
+
+// Cancel a job by id; a waiting controller job gives its buffer back
+void cancelJob(uint32_t id) {
+  PrintJob removed;
+  removed.samples = nullptr;
+  bool running = false;
+  
+  if (!scheduler->cancel(id, &removed, &running)) {
+    Serial.printf("✗ No job #%lu\n", (unsigned long)id);
+  } else if (running) {
+    Serial.printf("✓ Job #%lu stops at the next band\n", (unsigned long)id);
+  } else {
+    releaseSamples(removed);
+    if (removed.kind == JOB_RAW) rawRing->abort();   // Client is dropped
+    Serial.printf("✓ Job #%lu cancelled\n", (unsigned long)id);
+  }
+}
+
+// ======== Sample Frame Reception ========
+// Reads one frame into rxBuffer and hands it to the print task. The ACK is
+// withheld until the job is queued and a buffer for the next frame is free,
+// so a full scheduler throttles the controller instead of dropping data.
+void receiveSampleFrame(SampleFrameReader& reader, int16_t*& rxBuffer) {
+  if (!rxBuffer) {
+    reader.nak();
+    Serial.println("✗ No sample buffer allocated!");
+    return;
+  }
+  
+  uint16_t count = 0;
+  uint8_t channels = 1;
+  FrameResult result = reader.read(rxBuffer, SAMPLE_MAX_POINTS, count, &channels);
+  
+  if (result != FRAME_OK) {
+    reader.nak();
+    Serial.printf("✗ Sample frame rejected: %s\n", SampleFrameReader::resultName(result));
+    return;
+  }
+  
+  // A running live chart takes single-channel frames instead of the scheduler
+  xSemaphoreTake(liveMutex, portMAX_DELAY);
+  bool live = liveJobId != 0 && channels == 1;
+  if (live) {
+    LiveFrame frame = {rxBuffer, count};
+    xQueueSend(liveQueue, &frame, 0);
+  }
+  xSemaphoreGive(liveMutex);
+  
+  if (live) {
+    xQueueReceive(sampleFreeQueue, &rxBuffer, portMAX_DELAY);
+    reader.ack();
+    return;
+  }
+  
+  PrintJob job = makeJob(JOB_GRAPH, "Controller Data");
+  job.numPoints = count;
+  job.channels = channels;
+  job.samples = rxBuffer;
+  
+  uint32_t id;
+  while ((id = scheduler->submit(job, JOB_CLASS_NORMAL)) == 0) {
+    vTaskDelay(pdMS_TO_TICKS(50));
+  }
+  xQueueReceive(sampleFreeQueue, &rxBuffer, portMAX_DELAY);
+  
+  reader.ack();
+  Serial.printf("✓ Sample frame queued as job #%lu (%d points, %d channel(s))\n",
+                (unsigned long)id, count, channels);
+}
+
+// ======== Network Ingestion ========
+// Port-9100 client connected: queue a passthrough job for its bytes. Until
+// the job runs they collect in the ring, then TCP holds the client back.
+bool rawSessionHook(ByteRing& ring, void* ctx) {
+  rawRing = &ring;
+  PrintJob job = makeJob(JOB_RAW, "Raw ESC/POS");
+  
+  uint32_t id;
+  while ((id = scheduler->submit(job, JOB_CLASS_NORMAL)) == 0) {
+    vTaskDelay(pdMS_TO_TICKS(50));
+  }
+  Serial.printf("✓ Raw print client queued as job #%lu\n", (unsigned long)id);
+  return true;
+}
+
+// POST /samples: one sample frame read into a free buffer and queued like
+// a controller frame. Answers 503 when no buffer or queue slot frees up
+// within NET_SUBMIT_WAIT_MS, so submitters back off while the printer is busy.
+uint16_t samplePostHook(Stream& body, size_t length, char* reply, size_t replyLen, void* ctx) {
+  int16_t* samples;
+  if (xQueueReceive(sampleFreeQueue, &samples, pdMS_TO_TICKS(NET_SUBMIT_WAIT_MS)) != pdTRUE) {
+    snprintf(reply, replyLen, "busy: no sample buffer free");
+    return 503;
+  }
+  
+  uint8_t magic = 0;
+  uint16_t count = 0;
+  uint8_t channels = 1;
+  SampleFrameReader reader(body);
+  FrameResult result = FRAME_BAD_HEADER;
+  if (body.readBytes(&magic, 1) == 1 && magic == FRAME_MAGIC0) {
+    result = reader.read(samples, SAMPLE_MAX_POINTS, count, &channels);
+  }
+  if (result != FRAME_OK) {
+    xQueueSend(sampleFreeQueue, &samples, 0);
+    snprintf(reply, replyLen, "rejected: %s", SampleFrameReader::resultName(result));
+    return 400;
+  }
+  
+  PrintJob job = makeJob(JOB_GRAPH, "Network Data");
+  job.numPoints = count;
+  job.channels = channels;
+  job.samples = samples;
+  
+  uint32_t id;
+  uint32_t start = millis();
+  while ((id = scheduler->submit(job, JOB_CLASS_NORMAL)) == 0) {
+    if (millis() - start > NET_SUBMIT_WAIT_MS) {
+      xQueueSend(sampleFreeQueue, &samples, 0);
+      snprintf(reply, replyLen, "busy: print queue full");
+      return 503;
+    }
+    vTaskDelay(pdMS_TO_TICKS(50));
+  }
+  
+  snprintf(reply, replyLen, "queued as job #%lu", (unsigned long)id);
+  Serial.printf("✓ Network frame queued as job #%lu (%d points, %d channel(s))\n",
+                (unsigned long)id, count, channels);
+  return 202;
+}
+
+// ======== Serial Commands ========
+// A command line is a keyword (its leading letters, any case) and an
+// argument (the rest, leading spaces skipped): "R2" is R with "2",
+// "RL 5" is RL with "5", "STATS RESET" is STATS with "RESET".
+enum CommandArgs { ARG_NONE, ARG_OPTIONAL, ARG_REQUIRED };
+
+struct Command {
+  const char* keyword;
+  uint8_t args;                     // CommandArgs
+  bool (*run)(const char* arg);     // false = bad argument, usage is shown
+  const char* usage;
+  const char* help;
+};
+
+bool cmdPattern(const char* arg) {
+  if (strcmp(arg, "1") == 0) {
+    PrintJob job = makeJob(JOB_GRAPH, "Quadratic Curve");
+    job.pattern = 1;
+    job.numPoints = 4800;
+    submitJob(job, JOB_CLASS_BULK, 1, "Pattern 1");
+  } else if (strcmp(arg, "2") == 0) {
+    PrintJob job = makeJob(JOB_GRAPH, "Linear Curve");
+    job.pattern = 2;
+    job.numPoints = 4800;
+    submitJob(job, JOB_CLASS_BULK, 2, "Pattern 2");
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool cmdOverlay(const char* arg) {
+  PrintJob job = makeJob(JOB_GRAPH, "Quadratic + Linear");
+  job.pattern = 1;
+  job.channels = 2;
+  job.numPoints = 2 * 4800;
+  submitJob(job, JOB_CLASS_BULK, 3, "Patterns 1 + 2");
+  return true;
+}
+
+bool isNumber(const char* arg) {
+  if (!*arg) return false;
+  while (isdigit((uint8_t)*arg)) arg++;
+  return *arg == '\0';
+}
+
+bool cmdReprint(const char* arg) {
+  if (*arg && !(arg[0] >= '1' && arg[0] <= '9' && arg[1] == '\0')) return false;
+  PrintJob job = makeJob(JOB_REPRINT, "Reprint");
+  job.reprint = *arg ? arg[0] - '0' : 1;
+  submitJob(job, JOB_CLASS_NORMAL, 0, "Reprint");
+  return true;
+}
+
+bool cmdLogReprint(const char* arg) {
+  if (*arg && !isNumber(arg)) return false;
+  PrintJob job = makeJob(JOB_ARCHIVE, "Logged job");
+  job.logSeq = strtoul(arg, nullptr, 10);
+  submitJob(job, JOB_CLASS_NORMAL, 0, "Logged reprint");
+  return true;
+}
+
+bool cmdLog(const char* arg) {
+  if (xSemaphoreTake(logMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+    Serial.printf("Job log (%d jobs):\n", jobLog->getCount());
+    jobLog->print();
+    xSemaphoreGive(logMutex);
+  } else {
+    Serial.println("✗ Job log busy (a logged job is printing)");
+  }
+  return true;
+}
+
+bool cmdText(const char* arg) {
+  submitJob(makeJob(JOB_TEXT, arg), JOB_CLASS_URGENT, 0, "Receipt");
+  return true;
+}
+
+bool cmdCancel(const char* arg) {
+  if (!isNumber(arg)) return false;
+  cancelJob(strtoul(arg, nullptr, 10));
+  return true;
+}
+
+bool cmdQueue(const char* arg) {
+  Serial.println("Jobs:");
+  scheduler->printJobs();
+  return true;
+}
+
+bool cmdLatency(const char* arg) {
+  Serial.println("Latency (mean/max wait, mean/p95/max total):");
+  scheduler->printStats();
+  return true;
+}
+
+bool cmdStatus(const char* arg) {
+  xSemaphoreTake(statusMutex, portMAX_DELAY);
+  SystemStatus status = currentStatus;
+  xSemaphoreGive(statusMutex);
+  
+  const char* statusStr[] = {"IDLE", "STARTING", "PROCESSING", "SUCCESS", "FAILURE"};
+  Serial.printf("Status: %s\n", statusStr[status]);
+  return true;
+}
+
+bool cmdStats(const char* arg) {
+  if (strcasecmp(arg, "RESET") == 0) {
+    PrintStats::reset();
+    Serial.println("✓ Stats cleared");
+    return true;
+  }
+  if (*arg) return false;
+#if PRINT_STATS
+  Serial.println("Stats:");
+  PrintStats::print();
+  for (uint8_t i = 0; i < arenaCount; i++) {
+    char name[12];
+    sprintf(name, "Task %d", i);
+    arenas[i]->print(name);
+  }
+#else
+  Serial.println("✗ Stats compiled out (PRINT_STATS=0)");
+#endif
+  return true;
+}
+
+bool cmdLive(const char* arg) {
+  if (!*arg) {
+    submitJob(makeJob(JOB_LIVE, "Live Pressure"), JOB_CLASS_NORMAL, 0, "Live chart");
+  } else if (strcasecmp(arg, "P1") == 0 || strcasecmp(arg, "P2") == 0) {
+    PrintJob job = makeJob(JOB_LIVE, "Live Demo");
+    job.pattern = arg[1] - '0';
+    job.numPoints = 4800;
+    submitJob(job, JOB_CLASS_NORMAL, 0, "Live demo");
+  } else if (strcasecmp(arg, "STOP") == 0) {
+    xSemaphoreTake(liveMutex, portMAX_DELAY);
+    uint32_t id = liveJobId;
+    xSemaphoreGive(liveMutex);
+    if (id) {
+      cancelJob(id);
+    } else {
+      Serial.println("✗ No live chart running");
+    }
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool cmdReduce(const char* arg) {
+  const char* names[] = {"MAX", "ENV", "LTTB"};
+  uint8_t i = 0;
+  while (i < 3 && strcasecmp(arg, names[i]) != 0) i++;
+  if (i == 3) return false;
+  curveReduction = (CurveReduction)i;
+  Serial.printf("✓ Graphs reduced by %s\n", names[i]);
+  return true;
+}
+
+bool cmdHelp(const char* arg);
+
+const Command COMMANDS[] = {
+  {"P",      ARG_REQUIRED, cmdPattern,    "P1 / P2",             "Print Pattern 1 (Quadratic) / 2 (Linear)"},
+  {"PM",     ARG_NONE,     cmdOverlay,    "PM",                  "Print both patterns on one graph"},
+  {"R",      ARG_OPTIONAL, cmdReprint,    "R / R2 .. R9",        "Reprint last job / an older one"},
+  {"RL",     ARG_OPTIONAL, cmdLogReprint, "RL / RL <n>",         "Reprint last logged job from flash / job n"},
+  {"LOG",    ARG_NONE,     cmdLog,        "LOG",                 "List logged jobs"},
+  {"T",      ARG_REQUIRED, cmdText,       "T <text>",            "Urgent text receipt"},
+  {"C",      ARG_REQUIRED, cmdCancel,     "C <id>",              "Cancel job"},
+  {"Q",      ARG_NONE,     cmdQueue,      "Q",                   "Job queue"},
+  {"L",      ARG_NONE,     cmdLatency,    "L",                   "Latency per priority class"},
+  {"S",      ARG_NONE,     cmdStatus,     "S",                   "Status query"},
+  {"STATS",  ARG_OPTIONAL, cmdStats,      "STATS [RESET]",       "Stage timings, bytes, heap (RESET clears)"},
+  {"LIVE",   ARG_OPTIONAL, cmdLive,       "LIVE [P1|P2|STOP]",   "Strip chart of sample frames (P1 / P2 = demo)"},
+  {"REDUCE", ARG_REQUIRED, cmdReduce,     "REDUCE MAX|ENV|LTTB", "Downsampling of later graphs"},
+  {"HELP",   ARG_NONE,     cmdHelp,       "HELP",                "This list"}
+};
+
+const uint8_t COMMAND_COUNT = sizeof(COMMANDS) / sizeof(COMMANDS[0]);
+
+bool cmdHelp(const char* arg) {
+  Serial.println("Commands:");
+  for (uint8_t i = 0; i < COMMAND_COUNT; i++) {
+    Serial.printf("  %-19s = %s\n", COMMANDS[i].usage, COMMANDS[i].help);
+  }
+  Serial.println("  Binary sample frames are accepted at any time");
+  return true;
+}
+
+// Split a line into keyword and argument and run its command
+void runCommand(const char* line) {
+  size_t len = 0;
+  while (isalpha((uint8_t)line[len])) len++;
+  const char* arg = line + len;
+  while (*arg == ' ') arg++;
+  
+  for (uint8_t i = 0; i < COMMAND_COUNT; i++) {
+    const Command& command = COMMANDS[i];
+    if (len == 0 || strlen(command.keyword) != len || strncasecmp(line, command.keyword, len) != 0) {
+      continue;
+    }
+    bool argOk = *arg ? command.args != ARG_NONE : command.args != ARG_REQUIRED;
+    if (!argOk || !command.run(arg)) {
+      Serial.printf("✗ Usage: %s\n", command.usage);
+    }
+    return;
+  }
+  Serial.println("✗ Unknown command (HELP lists them)");
+}
+
 // ======== Serial Command Task ========
+TaskHandle_t serialTask = nullptr;
+
+// Runs in the UART event task when bytes arrive (FIFO threshold or RX
+// timeout); the command task sleeps until then
+void onSerialReceive() {
+  xTaskNotifyGive(serialTask);
+}
+
 void taskSerialCommand(void* param) {
   char buffer[64];
   uint8_t index = 0;
   
-  Serial.println("\nCommands:");
-  Serial.println("  P1 = Print Pattern 1 (Quadratic)");
-  Serial.println("  P2 = Print Pattern 2 (Linear)");
-  Serial.println("  S  = Status query");
+  SampleFrameReader reader(CONTROLLER_SERIAL);
+  int16_t* rxBuffer = nullptr;
+  xQueueReceive(sampleFreeQueue, &rxBuffer, 0);
+  
+  // RX event after one idle symbol instead of the driver's ten
+  serialTask = xTaskGetCurrentTaskHandle();
+  CONTROLLER_SERIAL.setRxTimeout(1);
+  CONTROLLER_SERIAL.onReceive(onSerialReceive);
+  
+  Serial.println();
+  cmdHelp("");
   
   while (1) {
-    if (Serial.available()) {
-      char c = Serial.read();
+    // Drain first: a byte arriving after the check notifies the wait below
+    while (CONTROLLER_SERIAL.available()) {
+      char c = CONTROLLER_SERIAL.read();
+      
+      // Frame magic cannot start a text command
+      if ((uint8_t)c == FRAME_MAGIC0 && index == 0) {
+        receiveSampleFrame(reader, rxBuffer);
+        continue;
+      }
       
       if (c == '\n' || c == '\r') {
         if (index > 0) {
           buffer[index] = '\0';
-          
-          // Parse command
-          if (strcmp(buffer, "P1") == 0 || strcmp(buffer, "p1") == 0) {
-            PrintJob job;
-            job.pattern = 1;
-            job.numPoints = 4800;
-            strcpy(job.description, "Quadratic Curve");
-            
-            if (xQueueSend(printQueue, &job, pdMS_TO_TICKS(100)) == pdTRUE) {
-              Serial.println("✓ Print job queued (Pattern 1)");
-            } else {
-              Serial.println("✗ Queue full!");
-            }
-          }
-          else if (strcmp(buffer, "P2") == 0 || strcmp(buffer, "p2") == 0) {
-            PrintJob job;
-            job.pattern = 2;
-            job.numPoints = 4800;
-            strcpy(job.description, "Linear Curve");
-            
-            if (xQueueSend(printQueue, &job, pdMS_TO_TICKS(100)) == pdTRUE) {
-              Serial.println("✓ Print job queued (Pattern 2)");
-            } else {
-              Serial.println("✗ Queue full!");
-            }
-          }
-          else if (strcmp(buffer, "S") == 0 || strcmp(buffer, "s") == 0) {
-            xSemaphoreTake(statusMutex, portMAX_DELAY);
-            SystemStatus status = currentStatus;
-            xSemaphoreGive(statusMutex);
-            
-            const char* statusStr[] = {"IDLE", "STARTING", "PROCESSING", "SUCCESS", "FAILURE"};
-            Serial.printf("Status: %s\n", statusStr[status]);
-          }
-          else {
-            Serial.println("✗ Unknown command");
-          }
-          
+          runCommand(buffer);
           index = 0;
         }
       }
@@ -157,105 +668,445 @@ void taskSerialCommand(void* param) {
       }
     }
     
-    vTaskDelay(pdMS_TO_TICKS(10));
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
   }
 }
 
 // ======== Print Job Task ========
+// Show a job result on the LED for up to 2 s (cut short by waiting jobs)
+void showResult(SystemStatus status) {
+  setStatus(status);
+  for (uint8_t i = 0; i < 40 && scheduler->waiting() == 0; i++) {
+    vTaskDelay(pdMS_TO_TICKS(50));
+  }
+  setStatus(STATUS_IDLE);
+}
+
+// Printer on one pool port, ready for begin()
+ThermalPrinter* createPrinter(const PrinterPort& port) {
+  HardwareSerial* serial = new HardwareSerial(port.uart);
+  serial->setTxBufferSize(PRINTER_TX_BUFFER);
+  serial->begin(PRINTER_BAUD, SERIAL_8N1, port.rx, port.tx);
+  
+  ThermalPrinter* printer = new ThermalPrinter(*serial, (uart_port_t)port.uart);
+  printer->setPacing(PRINTER_PACING, port.busyPin, port.rtsPin);
+  printer->setRasterCompression(PRINTER_SKIP_BLANK);
+  printer->setProfile(PRINTER_PROFILE);
+  return printer;
+}
+
+// Replay a recorded job on the task's first printer (the caller
+// finishes the job before showing the result)
+bool reprintJob(ThermalPrinter* printer, uint8_t age) {
+  xSemaphoreTake(historyMutex, portMAX_DELAY);
+  const JobStream* stream = history->get(age - 1);
+  
+  if (!stream) {
+    xSemaphoreGive(historyMutex);
+    Serial.printf("✗ No recorded job -%d to reprint\n", age);
+    return false;
+  }
+  
+  Serial.printf("\n▶ Reprinting job -%d (%u bytes)\n", age, (unsigned)stream->getSize());
+  setStatus(STATUS_PROCESSING);
+  
+  // Replay: no curve, no rendering (slot stays locked while it is read)
+  bool ok = printer->printStream(*stream);
+  xSemaphoreGive(historyMutex);
+  
+  Serial.println(ok ? "✓ Reprint completed!" : "✗ Reprint failed!");
+  return ok;
+}
+
+// Log a printed controller job (samples still in its frame buffer)
+void logJob(const PrintJob& job) {
+  if (!jobLog->isReady()) return;
+  
+  xSemaphoreTake(logMutex, portMAX_DELAY);
+  uint32_t seq = jobLog->append(job.samples, job.numPoints, job.channels, job.reduction,
+                                job.description);
+  xSemaphoreGive(logMutex);
+  
+  if (seq) {
+    Serial.printf("  ✓ Logged to flash as #%lu\n", (unsigned long)seq);
+  } else {
+    Serial.println("  ⚠ Job not logged to flash");
+  }
+}
+
+// End a logged job's print: unmap it, let appends erase it again
+void releaseArchive(MappedJob& archived) {
+  if (!archived.isValid()) return;
+  archived.unmap();
+  xSemaphoreGive(logMutex);
+}
+
+// Port-9100 session: bytes go to every printer of the pool as they
+// arrive; the session ends when the client closes or goes quiet
+void printRaw(PrinterPool* pool, uint32_t jobId) {
+  Serial.printf("\n▶ Raw job #%lu\n", (unsigned long)jobId);
+  setStatus(STATUS_PROCESSING);
+  
+  const uint8_t* span;
+  size_t n;
+  size_t total = 0;
+  bool ok = true;
+  while (ok && (n = rawRing->readSpan(span, pdMS_TO_TICKS(NET_IDLE_TIMEOUT_MS))) > 0) {
+    for (uint8_t p = 0; p < pool->getCount(); p++) {
+      ok &= pool->get(p)->printStream(span, n);
+    }
+    rawRing->commitRead(n);
+    total += n;
+    if (scheduler->isCancelled(jobId)) ok = false;
+  }
+  
+  // Cancelled, failed or the client stalled: drop the rest of the session
+  ok = ok && rawRing->isDrained();
+  if (!ok) rawRing->abort();
+  scheduler->finish(jobId);
+  
+  if (ok) {
+    Serial.printf("✓ Raw job completed (%u bytes)\n", (unsigned)total);
+    showResult(STATUS_SUCCESS);
+  } else {
+    Serial.printf("✗ Raw job stopped after %u bytes\n", (unsigned)total);
+    showResult(STATUS_FAILURE);
+  }
+}
+
+// Text receipt
+void printText(ThermalPrinter* printer, const PrintJob& job) {
+  printer->setAlign(ALIGN_CENTER);
+  printer->setFontSize(1, 1);
+  printer->println(job.description);
+  printer->feed(3);
+}
+
+// Graph job being printed (band hook context)
+struct RunningJob {
+  uint32_t id;
+  uint8_t cls;
+  bool slotReceipts;    // One printer: receipts may break into the page
+};
+
+// Band boundary of a graph: stop it if it was cancelled, otherwise cut
+// the page and slot in the urgent receipts waiting behind it. The hook
+// runs on one printer only, so fan-out pools keep their copies identical
+// and print urgent receipts after the page instead.
+bool graphBandHook(uint16_t nextBand, ThermalPrinter& printer, void* ctx) {
+  RunningJob* running = (RunningJob*)ctx;
+  if (scheduler->isCancelled(running->id)) return false;
+  if (!running->slotReceipts) return true;
+  
+  PrintJob urgent;
+  uint32_t id;
+  uint8_t above = min(running->cls, (uint8_t)JOB_CLASS_NORMAL);  // Urgent only
+  if (!scheduler->takeAbove(urgent, id, above)) return true;
+  
+  // Receipts are not part of the graph's recorded stream
+  JobStream* recording = printer.getRecorder();
+  printer.setRecorder(nullptr);
+  printer.feed(3);
+  printer.cut();
+  
+  do {
+    Serial.printf("  ▶ Job #%lu slotted in before band %d\n", (unsigned long)id, nextBand);
+    printText(&printer, urgent);
+    printer.cut();
+    scheduler->finish(id);
+  } while (scheduler->takeAbove(urgent, id, above));
+  
+  printer.setRecorder(recording);
+  return true;
+}
+
+// Live strip chart on every printer of the pool: controller frames (or a
+// synthetic pattern fed in real time) are printed band by band until the
+// job is cancelled (LIVE STOP / C <id>) or the pattern ends
+void printLive(PrinterPool* pool, JobArena* arena, uint32_t jobId, const PrintJob& job) {
+  Serial.printf("\n▶ Live chart #%lu: %s\n", (unsigned long)jobId, job.description);
+  setStatus(STATUS_PROCESSING);
+  
+  for (uint8_t p = 0; p < pool->getCount(); p++) {
+    ThermalPrinter* printer = pool->get(p);
+    printer->setAlign(ALIGN_CENTER);
+    printer->setFontSize(2, 2);
+    printer->println(job.description);
+    printer->feed(8);
+  }
+  
+  StripChart chart(PageLayout(), LIVE_SAMPLES_PER_ROW, BAND_ROWS, arena);
+  if (!chart.begin(pool->getPrinters(), pool->getCount())) {
+    scheduler->finish(jobId);
+    Serial.println("✗ Strip chart allocation failed!");
+    showResult(STATUS_FAILURE);
+    return;
+  }
+  
+  xSemaphoreTake(liveMutex, portMAX_DELAY);
+  liveJobId = jobId;
+  xSemaphoreGive(liveMutex);
+  
+  BuildUpSource synthetic(job.numPoints, job.pattern, PageLayout::Y_MAX, micros());
+  uint16_t fed = 0;
+  bool ok = true;
+  
+  while (ok && !scheduler->isCancelled(jobId)) {
+    if (job.pattern) {
+      if (fed >= job.numPoints) break;
+      for (uint8_t i = 0; i < LIVE_DEMO_RATE / 10 && fed < job.numPoints && ok; i++, fed++) {
+        ok = chart.addSample(synthetic.next());
+      }
+      vTaskDelay(pdMS_TO_TICKS(100));
+    } else {
+      LiveFrame frame;
+      if (xQueueReceive(liveQueue, &frame, pdMS_TO_TICKS(100)) == pdTRUE) {
+        ok = chart.addSamples(frame.samples, frame.count);
+        xQueueSend(sampleFreeQueue, &frame.samples, portMAX_DELAY);
+      }
+    }
+  }
+  
+  // Stop taking frames and hand back the ones still queued
+  xSemaphoreTake(liveMutex, portMAX_DELAY);
+  liveJobId = 0;
+  xSemaphoreGive(liveMutex);
+  
+  LiveFrame frame;
+  while (xQueueReceive(liveQueue, &frame, 0) == pdTRUE) {
+    xQueueSend(sampleFreeQueue, &frame.samples, portMAX_DELAY);
+  }
+  
+  ok = chart.finish() && ok;
+  scheduler->finish(jobId);
+  
+  if (!ok) {
+    Serial.println("✗ Live chart failed!");
+    showResult(STATUS_FAILURE);
+    return;
+  }
+  
+  for (uint8_t p = 0; p < pool->getCount(); p++) {
+    ThermalPrinter* printer = pool->get(p);
+    printer->feed(2);
+    printer->setFontSize(2, 2);
+    printer->println("PRESSURE");
+    printer->feed(3);
+  }
+  
+  Serial.printf("✓ Live chart completed (%lu rows)\n", (unsigned long)chart.getRows());
+  showResult(STATUS_SUCCESS);
+}
+
+// Prints every job it takes from the scheduler on all printers of its pool
 void taskPrintJob(void* param) {
-  ThermalPrinter* printer = new ThermalPrinter(PrinterSerial);
+  PrintWorker* worker = (PrintWorker*)param;
+  PrinterPool* pool = worker->pool;
+  JobArena* arena = worker->arena;
   
-  // Initialize printer
-  if (!printer->begin()) {
+  // Initialize printers
+  if (pool->begin(PRINTER_LINK, PRINTER_BAUD) == 0) {
     Serial.println("✗ Printer initialization failed!");
     setStatus(STATUS_FAILURE);
     vTaskDelete(NULL);
     return;
   }
   
-  printer->setDensity(10, 2);
-  printer->setLineHeight(24);
+  for (uint8_t p = 0; p < pool->getCount(); p++) {
+    pool->get(p)->setDensity(PRINTER_PROFILE);
+    pool->get(p)->setLineHeight(24);
+  }
+  
+  // Band ring shared with the render task (allocated once, reused per job)
+  BandPipeline* pipeline = new BandPipeline(PageLayout::WIDTH, BAND_ROWS, PIPELINE_BANDS, RENDER_CORE);
+  if (!pipeline->isValid()) {
+    Serial.println("⚠ Band pipeline unavailable, rendering sequentially");
+  }
+  
+  // Recorded for reprints: the bytes sent to the first printer
+  ThermalPrinter* primary = pool->get(0);
   
   while (1) {
     PrintJob job;
+    uint32_t jobId;
     
-    // Wait for print job
-    if (xQueueReceive(printQueue, &job, portMAX_DELAY) == pdTRUE) {
-      Serial.printf("\n▶ Starting print job: %s\n", job.description);
-      setStatus(STATUS_STARTING);
-      vTaskDelay(pdMS_TO_TICKS(500));
+    // Wait for the most urgent job (the first idle print task takes it)
+    if (scheduler->take(job, jobId)) {
+      // The previous job's buffers are no longer used
+      arena->reset();
       
-      setStatus(STATUS_PROCESSING);
+      if (job.kind == JOB_REPRINT) {
+        bool ok = reprintJob(primary, job.reprint);
+        scheduler->finish(jobId);
+        showResult(ok ? STATUS_SUCCESS : STATUS_FAILURE);
+        continue;
+      }
       
-      // Create canvas
-      uint16_t totalHeight = 1200 + 70 + 10;
-      BitmapCanvas* canvas = new BitmapCanvas(512, totalHeight);
+      if (job.kind == JOB_TEXT) {
+        Serial.printf("\n▶ Receipt #%lu: %s\n", (unsigned long)jobId, job.description);
+        for (uint8_t p = 0; p < pool->getCount(); p++) {
+          printText(pool->get(p), job);
+        }
+        scheduler->finish(jobId);
+        showResult(STATUS_SUCCESS);
+        continue;
+      }
       
-      if (!canvas || !canvas->isValid()) {
-        Serial.println("✗ Canvas allocation failed!");
-        setStatus(STATUS_FAILURE);
-        vTaskDelay(pdMS_TO_TICKS(2000));
-        setStatus(STATUS_IDLE);
+      if (job.kind == JOB_LIVE) {
+        printLive(pool, arena, jobId, job);
         continue;
       }
       
-      canvas->clear();
+      if (job.kind == JOB_RAW) {
+        printRaw(pool, jobId);
+        continue;
+      }
       
-      // Create graph
-      GraphGenerator generator(canvas, 512, 1200, 30, 70, 30, 2, 200, 25, 80, 60);
+      Serial.printf("\n▶ Starting print job #%lu: %s\n", (unsigned long)jobId, job.description);
+      setStatus(STATUS_STARTING);
+      vTaskDelay(pdMS_TO_TICKS(500));
       
-      generator.drawYAxisLabels();
-      generator.drawGrid(true);
-      generator.drawXAxisLabels();
+      setStatus(STATUS_PROCESSING);
       
-      float* curveData = generator.generateBuildUpCurve(job.numPoints, job.pattern);
+      // Logged jobs are rendered straight from memory-mapped flash; the
+      // log lock keeps the record from being erased until the print ends
+      MappedJob archived;
+      const int16_t* samples = job.samples;
+      uint32_t numPoints = job.numPoints;
+      if (job.kind == JOB_ARCHIVE) {
+        xSemaphoreTake(logMutex, portMAX_DELAY);
+        if (!jobLog->map(job.logSeq, archived)) {
+          xSemaphoreGive(logMutex);
+          scheduler->finish(jobId);
+          Serial.println("✗ Logged job not found or corrupt!");
+          showResult(STATUS_FAILURE);
+          continue;
+        }
+        samples = archived.samples();
+        numPoints = archived.count();
+        job.channels = archived.channels();
+        job.reduction = archived.reduction();
+        snprintf(job.description, sizeof(job.description), "%s", archived.description());
+        Serial.printf("  Logged job #%lu, %lu points\n", (unsigned long)archived.seq(),
+                      (unsigned long)numPoints);
+      }
+      
+      // Create graph (drawing target is bound per band)
+      uint16_t totalHeight = PageLayout::PAGE_HEIGHT;
+      GraphGenerator generator(nullptr, PageLayout());
+      generator.setReduction((CurveReduction)job.reduction);
+      generator.setArena(arena);
+      
+      // Curves are streamed per band: from the frame buffer (or flash) for
+      // controller data (one per channel), generated on the fly for
+      // synthetic patterns (PM: pattern 1 and 2 on the same axes)
+      uint8_t channels = constrain(job.channels, 1, GRAPH_MAX_SERIES);
+      uint32_t perChannel = numPoints / channels;
+      BuildUpSource synthetic(perChannel, job.pattern, PageLayout::Y_MAX, micros());
+      BuildUpSource synthetic2(perChannel, job.pattern % 2 + 1, PageLayout::Y_MAX, micros() + 1);
+      SampleSource* sources[] = {&synthetic, &synthetic2};
+      bool prepared = samples
+        ? generator.prepareSeries(samples, perChannel, channels, SERIES_STYLES)
+        : generator.prepareSeries(sources, min(channels, (uint8_t)2), SERIES_STYLES);
       
-      if (!curveData) {
-        Serial.println("✗ Curve generation failed!");
-        delete canvas;
-        setStatus(STATUS_FAILURE);
-        vTaskDelay(pdMS_TO_TICKS(2000));
-        setStatus(STATUS_IDLE);
+      BandRenderer renderer(generator, PageLayout::WIDTH, totalHeight, BAND_ROWS);
+      
+      if (!prepared || !renderer.isValid()) {
+        releaseArchive(archived);
+        releaseSamples(job);
+        scheduler->finish(jobId);
+        Serial.println("✗ Curve/band allocation failed!");
+        showResult(STATUS_FAILURE);
         continue;
       }
       
-      generator.drawCurve(curveData, job.numPoints, 1);
-      free(curveData);
+      renderer.setGridDashed(true);
+      renderer.setCurveThickness(1);
+      renderer.setBackgroundCache(background);
+      
+      // Urgent receipts and cancellation are handled between bands
+      RunningJob running = {jobId, scheduler->classOf(jobId),
+                            pool->getCount() == 1 || pool->getMode() == POOL_BALANCE};
+      renderer.setBandHook(graphBandHook, &running);
       
-      generator.drawBottomLabel();
+      // Print (and record the bytes for reprints)
+      xSemaphoreTake(historyMutex, portMAX_DELAY);
+      JobStream* recording = history->begin();
+      xSemaphoreGive(historyMutex);
+      primary->setRecorder(recording);
+      
+      for (uint8_t p = 0; p < pool->getCount(); p++) {
+        ThermalPrinter* printer = pool->get(p);
+        printer->setAlign(ALIGN_CENTER);
+        printer->setFontSize(2, 2);
+        printer->println(job.description);
+        printer->feed(8);
+      }
       
-      // Print
-      printer->setAlign(ALIGN_CENTER);
-      printer->setFontSize(2, 2);
-      printer->println(job.description);
-      printer->feed(8);
+      // Render on core 1 while this task (and one sender per extra
+      // printer) streams finished bands
+      bool printed = true;
+      if (pipeline->isValid()) {
+        printed = pool->print(renderer, *pipeline);
+      } else {
+        uint16_t width = PageLayout::WIDTH;
+        BitmapCanvas band(width, BAND_ROWS,
+                          (uint8_t*)arena->alloc(BitmapCanvas::bufferSize(width, BAND_ROWS)));
+        for (uint8_t p = 0; p < pool->getCount(); p++) {
+          printed &= renderer.print(*pool->get(p), band);
+        }
+      }
+      releaseArchive(archived);
+      if (printed && job.samples) logJob(job);
+      releaseSamples(job);
       
-      if (!printer->printBitmap(canvas->getWidth(), canvas->getHeight(), canvas->getData())) {
-        Serial.println("✗ Printing failed!");
-        delete canvas;
-        setStatus(STATUS_FAILURE);
-        vTaskDelay(pdMS_TO_TICKS(2000));
-        setStatus(STATUS_IDLE);
+      if (!printed) {
+        primary->setRecorder(nullptr);
+        xSemaphoreTake(historyMutex, portMAX_DELAY);
+        history->discard(recording);
+        xSemaphoreGive(historyMutex);
+        
+        bool cancelled = scheduler->isCancelled(jobId);
+        scheduler->finish(jobId);
+        
+        if (cancelled) {
+          for (uint8_t p = 0; p < pool->getCount(); p++) {
+            pool->get(p)->feed(3);
+          }
+          Serial.printf("✗ Print job #%lu cancelled\n", (unsigned long)jobId);
+        } else {
+          Serial.println("✗ Printing failed!");
+        }
+        showResult(STATUS_FAILURE);
         continue;
       }
       
-      printer->feed(2);
-      printer->setFontSize(2, 2);
-      printer->println("PRESSURE");
-      printer->feed(3);
+      for (uint8_t p = 0; p < pool->getCount(); p++) {
+        ThermalPrinter* printer = pool->get(p);
+        printer->feed(2);
+        printer->setFontSize(2, 2);
+        printer->println("PRESSURE");
+        printer->feed(3);
+      }
       
-      delete canvas;
+      primary->setRecorder(nullptr);
+      xSemaphoreTake(historyMutex, portMAX_DELAY);
+      bool recorded = history->commit(recording);
+      xSemaphoreGive(historyMutex);
+      if (!recorded) {
+        Serial.println("⚠ Job too large to record, no reprint available");
+      }
       
+      scheduler->finish(jobId);
       Serial.println("✓ Print job completed!");
-      setStatus(STATUS_SUCCESS);
-      vTaskDelay(pdMS_TO_TICKS(2000));
-      setStatus(STATUS_IDLE);
+      showResult(STATUS_SUCCESS);
     }
   }
 }
 
 // ======== Setup ========
 void setup() {
+  Serial.setRxBufferSize(SERIAL_RX_BUFFER);
   Serial.begin(115200);
   delay(1000);
   
@@ -270,18 +1121,83 @@ void setup() {
   leds[0] = CRGB::Black;
   FastLED.show();
   
-  // Initialize printer serial
-  PrinterSerial.begin(PRINTER_BAUD, SERIAL_8N1, PRINTER_RX, PRINTER_TX);
+  // Initialize printer serial ports (printers are set up by their print task)
+  ThermalPrinter* printers[PRINTER_COUNT];
+  for (uint8_t i = 0; i < PRINTER_COUNT; i++) {
+    printers[i] = createPrinter(PRINTER_PORTS[i]);
+  }
   delay(500);
   
+  // Pre-render label glyphs (axis labels: 2x, TIME: 1x, both rotated)
+  GlyphCache::warm(2, true);
+  GlyphCache::warm(1, true);
+  
   // Create synchronization objects
   statusMutex = xSemaphoreCreateMutex();
-  printQueue = xQueueCreate(5, sizeof(PrintJob));
+  historyMutex = xSemaphoreCreateMutex();
+  liveMutex = xSemaphoreCreateMutex();
+  scheduler = new PrintScheduler<PrintJob>();
+  
+  background = new BackgroundCache();
+  history = new JobStreamCache();
+  
+  logMutex = xSemaphoreCreateMutex();
+  jobLog = new JobLog();
+  if (jobLog->begin()) {
+    Serial.printf("✓ Job log: %d jobs indexed, %lu KB partition\n", jobLog->getCount(),
+                  (unsigned long)(jobLog->capacityBytes() / 1024));
+  } else {
+    Serial.println("⚠ No \"" JOB_LOG_PARTITION "\" partition, jobs are not logged");
+  }
+  
+  // Sample buffers for controller frames (allocated once, read once per
+  // page: PSRAM when present)
+  sampleFreeQueue = xQueueCreate(SAMPLE_BUFFERS, sizeof(int16_t*));
+  liveQueue = xQueueCreate(SAMPLE_BUFFERS, sizeof(LiveFrame));
+  for (uint8_t i = 0; i < SAMPLE_BUFFERS; i++) {
+    int16_t* samples = (int16_t*)regionMalloc(SAMPLE_MAX_POINTS * sizeof(int16_t), REGION_PSRAM);
+    if (!samples) {
+      Serial.println("✗ Sample buffer allocation failed!");
+      break;
+    }
+    xQueueSend(sampleFreeQueue, &samples, 0);
+  }
   
   // Create tasks
-  xTaskCreatePinnedToCore(taskLED, "LED", 2048, NULL, 2, NULL, 1);
-  xTaskCreatePinnedToCore(taskSerialCommand, "SerialCmd", 4096, NULL, 1, NULL, 0);
-  xTaskCreatePinnedToCore(taskPrintJob, "PrintJob", 8192, NULL, 1, NULL, 0);
+  xTaskCreatePinnedToCore(taskLED, "LED", 2048, NULL, 2, &ledTask, 1);
+  // Above the print tasks on core 0: a command is handled as it arrives
+  xTaskCreatePinnedToCore(taskSerialCommand, "SerialCmd", 4096, NULL, 2, NULL, 0);
+  
+  // Print tasks: one for the whole pool (fan-out) or one per printer (balance)
+  uint8_t workers = PRINTER_POOL_MODE == POOL_BALANCE ? PRINTER_COUNT : 1;
+  for (uint8_t w = 0; w < workers; w++) {
+    PrintWorker* worker = new PrintWorker;
+    worker->pool = new PrinterPool(PRINTER_POOL_MODE);
+    for (uint8_t i = 0; i < PRINTER_COUNT; i++) {
+      if (workers == 1 || i == w) worker->pool->add(printers[i]);
+    }
+    
+    worker->arena = new JobArena();
+    if (!worker->arena->begin(JOB_ARENA_BYTES, REGION_INTERNAL)) {
+      Serial.println("⚠ Job arena not allocated, job buffers use the heap");
+    }
+    arenas[arenaCount++] = worker->arena;
+    
+    xTaskCreatePinnedToCore(taskPrintJob, "PrintJob", 8192, worker, 1, NULL, 0);
+  }
+  
+  // Wi-Fi front-end (its tasks start serving once the link is up)
+  if (strlen(WIFI_SSID) > 0) {
+    WiFi.mode(WIFI_STA);
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+    RawPrintServer* rawServer = new RawPrintServer();
+    SampleHttpServer* sampleServer = new SampleHttpServer();
+    if (rawServer->begin(rawSessionHook, nullptr) && sampleServer->begin(samplePostHook, nullptr)) {
+      Serial.printf("✓ Wi-Fi: joining %s\n", WIFI_SSID);
+    } else {
+      Serial.println("✗ Network tasks not started!");
+    }
+  }
   
   Serial.println("✓ System initialized");
   Serial.println("✓ Tasks created\n");
@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+"""
+Reference renders for the host benchmark (render_bench.cpp)
+Draws the cases the original Python canvas covers with
+tests/grid_test8.py's BitmapCanvas and writes them as golden PBMs:
+setpixel, grid, text (axis labels) and line2. Odd line widths, the
+curves and the bottom label are not comparable (the Python brush is
+asymmetric for odd widths, the curve data is random and the font has
+digits and 'K' only), so those goldens come from render_bench -w.
+
+usage: python3 reference.py [out_dir]   (default: golden/)
+"""
+
+import os
+import sys
+import types
+
+# grid_test8 talks to a printer; only its canvas is needed here
+sys.modules.setdefault("serial", types.ModuleType("serial"))
+HERE = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.join(HERE, "..", "..", "tests"))
+
+import grid_test8 as g  # noqa: E402
+
+PAGE_WIDTH = g.WIDTH
+PAGE_HEIGHT = g.HEIGHT + g.BOTTOM_MARGIN
+LINE_SIZE = 512
+
+
+def save(canvas, out_dir, name):
+    path = os.path.join(out_dir, name + ".pbm")
+    with open(path, "wb") as f:
+        f.write(b"P4\n%d %d\n" % (canvas.width, canvas.height))
+        f.write(bytes(canvas.data))
+    print(f"  ✓ {path}")
+
+
+def draw_pixels(c):
+    for y in range(PAGE_HEIGHT):
+        for x in range(PAGE_WIDTH):
+            if ((x ^ y) & 3) == 0:
+                c.set_pixel(x, y)
+
+
+# STEP 2 of create_complete_graph()
+def draw_grid(c):
+    for i in range(int(g.X_MAX / g.X_STEP) + 1):
+        y_pos = g.GRAPH_START_Y + i * g.GRID_X_SPACING
+        if y_pos < g.HEIGHT:
+            c.draw_horizontal_line(
+                y_pos, g.GRAPH_START_X, g.GRAPH_START_X + g.GRAPH_WIDTH, g.GRID_DASHED
+            )
+    for i in range(int(g.Y_MAX / g.Y_STEP) + 1):
+        x_pos = g.GRAPH_START_X + i * g.GRID_Y_SPACING
+        c.draw_vertical_line(x_pos, g.GRAPH_START_Y, g.HEIGHT, g.GRID_DASHED)
+
+
+# STEPS 1 and 3 of create_complete_graph()
+def draw_labels(c):
+    for i in range(int(g.Y_MAX / g.Y_STEP) + 1):
+        x_pos = g.GRAPH_START_X + i * g.GRID_Y_SPACING
+        value = i * g.Y_STEP
+        if value != 0:
+            c.draw_text(f"{value}K", x_pos - 13, 5, 2, rotate_90=True)
+    for i in range(int(g.X_MAX / g.X_STEP) + 1):
+        y_pos = g.GRAPH_START_Y + i * g.GRID_X_SPACING
+        if y_pos < g.HEIGHT - 10:
+            c.draw_text(str(i * g.X_STEP), 10, y_pos - 3, 2, rotate_90=True)
+
+
+# Same 32 spokes as drawSpokes() in render_bench.cpp
+def draw_spokes(c, thickness):
+    centre = LINE_SIZE // 2
+    r = LINE_SIZE // 2 - 16
+    for i in range(32):
+        edge = -r + (i % 8) * r // 4
+        dx, dy = [(edge, -r), (r, edge), (-edge, r), (-r, -edge)][i // 8]
+        if i & 1:
+            c.draw_line(centre + dx, centre + dy, centre, centre, thickness)
+        else:
+            c.draw_line(centre, centre, centre + dx, centre + dy, thickness)
+
+
+def main():
+    out_dir = sys.argv[1] if len(sys.argv) > 1 else os.path.join(HERE, "golden")
+    os.makedirs(out_dir, exist_ok=True)
+
+    for name, draw in (("setpixel", draw_pixels), ("grid", draw_grid), ("text", draw_labels)):
+        c = g.BitmapCanvas(PAGE_WIDTH, PAGE_HEIGHT)
+        draw(c)
+        save(c, out_dir, name)
+
+    c = g.BitmapCanvas(LINE_SIZE, LINE_SIZE)
+    draw_spokes(c, 2)
+    save(c, out_dir, "line2")
+
+
+if __name__ == "__main__":
+    main()
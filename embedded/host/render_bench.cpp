@@ -0,0 +1,397 @@
+/*
+ * render_bench.cpp
+ * Host benchmark for the canvas / graph renderer
+ * Builds BitmapCanvas.h and GraphGenerator.h against the Arduino shim in
+ * shim/ and times the drawing primitives on the printer's page layout.
+ * Every case also renders one image that is compared with a golden PBM,
+ * so a faster renderer that changes a single dot fails the run.
+ *
+ * usage: render_bench [-n iterations] [-g golden_dir] [-w out_dir] [-v]
+ */
+
+#include <Arduino.h>
+#include "../BitmapCanvas.h"
+#include "../GraphGenerator.h"
+#include "../SampleIndex.h"
+
+HostSerial Serial;
+
+// Page layout of the sketches (grid_test8.py)
+struct PageLayout {
+  static const uint16_t WIDTH = 512;
+  static const uint16_t HEIGHT = 1200;
+  static const uint16_t LEFT_MARGIN = 30;
+  static const uint16_t TOP_MARGIN = 70;
+  static const uint16_t BOTTOM_MARGIN = 10;
+  static const uint16_t X_MAX = 30;
+  static const uint16_t X_STEP = 2;
+  static const uint16_t Y_MAX = 200;
+  static const uint16_t Y_STEP = 25;
+  static const uint16_t GRID_X_SPACING = 80;
+  static const uint16_t GRID_Y_SPACING = 60;
+};
+
+static const uint16_t PAGE_WIDTH = PageLayout::WIDTH;
+static const uint16_t PAGE_HEIGHT = PageLayout::HEIGHT + PageLayout::TOP_MARGIN + PageLayout::BOTTOM_MARGIN;
+static const uint16_t LINE_SIZE = 512;
+
+// 576-dot head at 2x graph rows; one dot wider so rows need a pad byte
+static const uint16_t WIDE_WIDTH = 577;
+static const uint16_t WIDE_GRAPH = 2 * PageLayout::HEIGHT;
+static const uint16_t WIDE_HEIGHT = WIDE_GRAPH + PageLayout::TOP_MARGIN + PageLayout::BOTTOM_MARGIN;
+
+// Fixed sample seed: the curve goldens depend on it
+static const uint32_t CURVE_SEED = 12345;
+
+struct Options {
+  uint32_t iterations;
+  const char* goldenDir;
+  const char* outDir;
+};
+
+struct BenchCase {
+  const char* name;
+  uint16_t width;
+  uint16_t height;
+  uint32_t opsPerRun;       // Work units per run (setPixel calls, lines, points...)
+  const char* unit;
+  void (*setup)();
+  void (*draw)(BitmapCanvas& canvas);
+};
+
+// ======== Cases ========
+
+static GraphGenerator* pageGraph(BitmapCanvas& canvas) {
+  static GraphGenerator* graph = nullptr;
+  if (!graph) graph = new GraphGenerator(&canvas, PageLayout());
+  graph->setCanvas(&canvas);
+  return graph;
+}
+
+static void drawPixels(BitmapCanvas& canvas) {
+  for (int16_t y = 0; y < PAGE_HEIGHT; y++) {
+    for (int16_t x = 0; x < PAGE_WIDTH; x++) {
+      if (((x ^ y) & 3) == 0) canvas.setPixel(x, y);
+    }
+  }
+}
+
+static void drawGrid(BitmapCanvas& canvas) {
+  pageGraph(canvas)->drawGrid(true);
+}
+
+// Axis labels: digits and 'K' at size 2, rotated 90° (29 + 25 characters)
+static void drawLabels(BitmapCanvas& canvas) {
+  GraphGenerator* graph = pageGraph(canvas);
+  graph->drawYAxisLabels();
+  graph->drawXAxisLabels();
+}
+
+// 32 spokes from the centre: every octant, both directions
+static void drawSpokes(BitmapCanvas& canvas, uint8_t thickness) {
+  const int16_t c = LINE_SIZE / 2;
+  const int16_t r = LINE_SIZE / 2 - 16;
+  for (uint8_t i = 0; i < 32; i++) {
+    int16_t edge = -r + (int16_t)(i % 8) * r / 4;
+    int16_t dx = 0, dy = 0;
+    switch (i / 8) {
+      case 0: dx = edge; dy = -r; break;
+      case 1: dx = r; dy = edge; break;
+      case 2: dx = -edge; dy = r; break;
+      default: dx = -r; dy = -edge; break;
+    }
+    if (i & 1) {
+      canvas.drawLine(c + dx, c + dy, c, c, thickness);
+    } else {
+      canvas.drawLine(c, c, c + dx, c + dy, thickness);
+    }
+  }
+}
+
+static void drawLine1(BitmapCanvas& canvas) { drawSpokes(canvas, 1); }
+static void drawLine2(BitmapCanvas& canvas) { drawSpokes(canvas, 2); }
+static void drawLine3(BitmapCanvas& canvas) { drawSpokes(canvas, 3); }
+static void drawLine5(BitmapCanvas& canvas) { drawSpokes(canvas, 5); }
+
+static int16_t* curveSamples = nullptr;
+static uint32_t curveLength = 0;
+
+static void makeSamples(uint32_t points, uint8_t pattern) {
+  free(curveSamples);
+  curveSamples = (int16_t*)malloc(points * sizeof(int16_t));
+  curveLength = points;
+
+  BuildUpSource source(points, pattern, PageLayout::Y_MAX, CURVE_SEED);
+  for (uint32_t i = 0; i < points; i++) {
+    curveSamples[i] = source.next();
+  }
+}
+
+static void setupCurve4800() { makeSamples(4800, 1); }
+static void setupCurve48000() { makeSamples(48000, 2); }
+
+static void drawCurve(BitmapCanvas& canvas) {
+  pageGraph(canvas)->drawCurve(curveSamples, curveLength, 3);
+}
+
+// Noisy 500k-sample capture as a min..max envelope, from the raw
+// samples and from a min / max index over them (same image)
+static MinMaxIndex sampleIndex;
+
+static void setupEnvelope() { makeSamples(500000, 2); }
+
+static void setupIndexed() {
+  makeSamples(500000, 2);
+  sampleIndex.begin(curveSamples, curveLength);
+}
+
+static void drawReduced(BitmapCanvas& canvas, CurveReduction mode, SampleSource& source) {
+  GraphGenerator* graph = pageGraph(canvas);
+  graph->setReduction(mode);
+  graph->prepareCurve(source);
+  graph->drawPreparedCurve(1);
+  graph->releaseCurve();
+  graph->setReduction(REDUCE_MAX);
+}
+
+static void drawEnvelope(BitmapCanvas& canvas) {
+  BufferSource source(curveSamples, curveLength);
+  drawReduced(canvas, REDUCE_ENVELOPE, source);
+}
+
+static void drawIndexed(BitmapCanvas& canvas) {
+  IndexedSource source(sampleIndex);
+  drawReduced(canvas, REDUCE_ENVELOPE, source);
+}
+
+static void drawLttb(BitmapCanvas& canvas) {
+  BufferSource source(curveSamples, curveLength);
+  drawReduced(canvas, REDUCE_LTTB, source);
+}
+
+// Three interleaved 4800-point channels on one graph
+static const uint8_t SERIES = 3;
+static const SeriesStyle SERIES_STYLES[SERIES] = {{3, LINE_SOLID}, {1, LINE_DASHED}, {5, LINE_SOLID}};
+
+static void setupSeries() {
+  free(curveSamples);
+  curveSamples = (int16_t*)malloc(4800 * SERIES * sizeof(int16_t));
+  curveLength = 4800;
+
+  for (uint8_t c = 0; c < SERIES; c++) {
+    BuildUpSource source(4800, c % 2 + 1, PageLayout::Y_MAX, CURVE_SEED + c);
+    for (uint16_t i = 0; i < 4800; i++) {
+      curveSamples[i * SERIES + c] = source.next() / (c + 1);
+    }
+  }
+}
+
+// Full wide page: background and a 4800-point curve (downsampled), or a
+// 1000-point curve spread over the 2400 graph rows (interpolated)
+static GraphGenerator* widePage(BitmapCanvas& canvas) {
+  static GraphGenerator* graph = nullptr;
+  if (!graph) {
+    graph = new GraphGenerator(&canvas, WIDE_WIDTH, WIDE_GRAPH, PageLayout::LEFT_MARGIN,
+                               PageLayout::TOP_MARGIN, PageLayout::X_MAX, PageLayout::X_STEP,
+                               PageLayout::Y_MAX, PageLayout::Y_STEP, 2 * PageLayout::GRID_X_SPACING,
+                               (576 - 32) / 8);
+  }
+  graph->setCanvas(&canvas);
+  return graph;
+}
+
+static void setupCurve1000() { makeSamples(1000, 1); }
+
+static void drawWide(BitmapCanvas& canvas) {
+  GraphGenerator* graph = widePage(canvas);
+  graph->drawBackground(canvas, true);
+  graph->drawCurve(curveSamples, curveLength, 3);
+}
+
+static void drawSeries(BitmapCanvas& canvas) {
+  GraphGenerator* graph = pageGraph(canvas);
+  graph->prepareSeries(curveSamples, curveLength, SERIES, SERIES_STYLES);
+  graph->drawPreparedCurve(3);
+  graph->releaseCurve();
+}
+
+// 64 x 32 stamp (text plus a frame) blitted at every bit phase
+static BitmapCanvas* stamp = nullptr;
+
+static void setupStamp() {
+  if (stamp) return;
+  stamp = new BitmapCanvas(64, 32);
+  stamp->clear();
+  stamp->fillRect(0, 0, 64, 32);
+  stamp->clearRect(2, 2, 60, 28);
+  stamp->drawText("LOGO", 8, 9, 2);
+}
+
+static void drawStamps(BitmapCanvas& canvas) {
+  for (uint8_t i = 0; i < 64; i++) {
+    int16_t x = (i % 8) * 61 + i / 8;
+    int16_t y = (i / 8) * 150 + (i % 8) * 3;
+    canvas.blit(*stamp, 0, 0, 64, 32, x, y, (i & 1) ? BLEND_XOR : BLEND_OR);
+  }
+}
+
+// Background layer combined into the page, then inverted / cleared boxes
+static BitmapCanvas* layer = nullptr;
+
+static void setupLayer() {
+  if (layer) return;
+  layer = new BitmapCanvas(PAGE_WIDTH, PAGE_HEIGHT);
+  layer->clear();
+  pageGraph(*layer)->drawGrid(true);
+  pageGraph(*layer)->drawYAxisLabels();
+  pageGraph(*layer)->drawXAxisLabels();
+}
+
+static void drawCombine(BitmapCanvas& canvas) {
+  canvas.fillRect(0, 0, PAGE_WIDTH, PAGE_HEIGHT / 2);
+  canvas.combine(*layer, BLEND_XOR);
+  canvas.combine(*layer, BLEND_OR);
+  canvas.invertRect(37, 101, 300, 400);
+  canvas.clearRect(250, 700, 201, 301);
+}
+
+static const BenchCase CASES[] = {
+  {"setpixel",   PAGE_WIDTH, PAGE_HEIGHT, (uint32_t)PAGE_WIDTH * PAGE_HEIGHT / 4, "px", nullptr, drawPixels},
+  {"grid",       PAGE_WIDTH, PAGE_HEIGHT, 1, "grid", nullptr, drawGrid},
+  {"text",       PAGE_WIDTH, PAGE_HEIGHT, 29 + 25, "char", nullptr, drawLabels},
+  {"line1",      LINE_SIZE, LINE_SIZE, 32, "line", nullptr, drawLine1},
+  {"line2",      LINE_SIZE, LINE_SIZE, 32, "line", nullptr, drawLine2},
+  {"line3",      LINE_SIZE, LINE_SIZE, 32, "line", nullptr, drawLine3},
+  {"line5",      LINE_SIZE, LINE_SIZE, 32, "line", nullptr, drawLine5},
+  {"curve4800",  PAGE_WIDTH, PAGE_HEIGHT, 4800, "pt", setupCurve4800, drawCurve},
+  {"curve48000", PAGE_WIDTH, PAGE_HEIGHT, 48000, "pt", setupCurve48000, drawCurve},
+  {"env500k",    PAGE_WIDTH, PAGE_HEIGHT, 500000, "pt", setupEnvelope, drawEnvelope},
+  {"index500k",  PAGE_WIDTH, PAGE_HEIGHT, 500000, "pt", setupIndexed, drawIndexed},
+  {"lttb48000",  PAGE_WIDTH, PAGE_HEIGHT, 48000, "pt", setupCurve48000, drawLttb},
+  {"series3",    PAGE_WIDTH, PAGE_HEIGHT, 4800 * SERIES, "pt", setupSeries, drawSeries},
+  {"blit",       PAGE_WIDTH, PAGE_HEIGHT, 64, "stamp", setupStamp, drawStamps},
+  {"combine",    PAGE_WIDTH, PAGE_HEIGHT, 5, "op", setupLayer, drawCombine},
+  {"wide4800",   WIDE_WIDTH, WIDE_HEIGHT, 4800, "pt", setupCurve4800, drawWide},
+  {"wide1000",   WIDE_WIDTH, WIDE_HEIGHT, 1000, "pt", setupCurve1000, drawWide},
+};
+
+// ======== Golden bitmaps ========
+
+static bool writePbm(const char* path, const BitmapCanvas& canvas) {
+  FILE* f = fopen(path, "wb");
+  if (!f) return false;
+  fprintf(f, "P4\n%d %d\n", canvas.getWidth(), canvas.getHeight());
+  size_t bytes = (size_t)canvas.getBytesPerLine() * canvas.getHeight();
+  bool ok = fwrite(canvas.getData(), 1, bytes, f) == bytes;
+  fclose(f);
+  return ok;
+}
+
+// Compare with a golden PBM; returns the number of differing bytes
+// (-1 if the golden is missing or has another size)
+static long comparePbm(const char* path, const BitmapCanvas& canvas) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return -1;
+
+  int w = 0, h = 0;
+  long diff = -1;
+  if (fscanf(f, "P4 %d %d", &w, &h) == 2 && fgetc(f) != EOF &&
+      w == canvas.getWidth() && h == canvas.getHeight()) {
+    size_t bytes = (size_t)((w + 7) / 8) * h;
+    uint8_t* golden = (uint8_t*)malloc(bytes);
+    if (golden && fread(golden, 1, bytes, f) == bytes) {
+      diff = 0;
+      for (size_t i = 0; i < bytes; i++) {
+        if (golden[i] != canvas.getData()[i]) diff++;
+      }
+    }
+    free(golden);
+  }
+  fclose(f);
+  return diff;
+}
+
+// ======== Runner ========
+
+static bool runCase(const BenchCase& bench, const Options& opt) {
+  BitmapCanvas canvas(bench.width, bench.height);
+  if (!canvas.isValid()) return false;
+  if (bench.setup) bench.setup();
+
+  uint64_t total = 0;
+  uint32_t best = UINT32_MAX;
+  for (uint32_t i = 0; i < opt.iterations; i++) {
+    canvas.clear();
+    uint32_t start = micros();
+    bench.draw(canvas);
+    uint32_t us = micros() - start;
+    total += us;
+    if (us < best) best = us;
+  }
+
+  double mean = (double)total / opt.iterations;
+  double perOp = best * 1000.0 / bench.opsPerRun;
+  printf("  %-11s %6lu runs %10.1f us mean %8lu us best %10.1f ns/%s\n",
+         bench.name, (unsigned long)opt.iterations, mean, (unsigned long)best, perOp, bench.unit);
+
+  char path[512];
+  if (opt.outDir) {
+    snprintf(path, sizeof(path), "%s/%s.pbm", opt.outDir, bench.name);
+    if (!writePbm(path, canvas)) {
+      printf("  ✗ Cannot write %s\n", path);
+      return false;
+    }
+  }
+
+  if (!opt.goldenDir) return true;
+
+  snprintf(path, sizeof(path), "%s/%s.pbm", opt.goldenDir, bench.name);
+  long diff = comparePbm(path, canvas);
+  if (diff == 0) return true;
+
+  if (diff < 0) {
+    printf("  ✗ %s: no golden at %s\n", bench.name, path);
+  } else {
+    printf("  ✗ %s: %ld bytes differ from %s\n", bench.name, diff, path);
+  }
+  snprintf(path, sizeof(path), "%s.actual.pbm", bench.name);
+  if (writePbm(path, canvas)) printf("    rendered image saved as %s\n", path);
+  return false;
+}
+
+int main(int argc, char** argv) {
+  Options opt = {50, nullptr, nullptr};
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+      opt.iterations = strtoul(argv[++i], nullptr, 10);
+      if (opt.iterations == 0) opt.iterations = 1;
+    } else if (!strcmp(argv[i], "-g") && i + 1 < argc) {
+      opt.goldenDir = argv[++i];
+    } else if (!strcmp(argv[i], "-w") && i + 1 < argc) {
+      opt.outDir = argv[++i];
+    } else if (!strcmp(argv[i], "-v")) {
+      Serial.echo = true;
+    } else {
+      printf("usage: %s [-n iterations] [-g golden_dir] [-w out_dir] [-v]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  uint8_t failed = 0;
+  for (size_t i = 0; i < sizeof(CASES) / sizeof(CASES[0]); i++) {
+    if (!runCase(CASES[i], opt)) failed++;
+  }
+  free(curveSamples);
+  delete stamp;
+  delete layer;
+
+  if (opt.goldenDir) {
+    if (failed) {
+      printf("✗ %d case(s) differ from the golden bitmaps\n", failed);
+    } else {
+      printf("✓ All cases match the golden bitmaps\n");
+    }
+  }
+  return failed ? 1 : 0;
+}
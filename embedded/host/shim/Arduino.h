@@ -0,0 +1,91 @@
+/*
+ * Arduino.h (host shim)
+ * Just enough of the Arduino-ESP32 core to build the renderer headers
+ * on a PC: integer helpers, PROGMEM, timing, a Serial that goes to
+ * stdout (silent unless echo is set), the ESP heap getters and a
+ * portMUX that is a plain mutex.
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+
+using std::min;
+using std::max;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+
+inline unsigned long micros() {
+  using namespace std::chrono;
+  static const steady_clock::time_point start = steady_clock::now();
+  return (unsigned long)duration_cast<microseconds>(steady_clock::now() - start).count();
+}
+
+inline unsigned long millis() { return micros() / 1000; }
+inline void delay(unsigned long) {}
+inline void yield() {}
+
+class HostSerial {
+public:
+  bool echo;
+
+  HostSerial() : echo(false) {}
+
+  void begin(unsigned long) {}
+
+  size_t write(const uint8_t* buf, size_t len) {
+    return echo ? fwrite(buf, 1, len, stdout) : len;
+  }
+
+  size_t print(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+
+  size_t println(const char* s = "") {
+    size_t n = print(s);
+    return n + print("\n");
+  }
+
+  size_t printf(const char* format, ...) {
+    char buf[256];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    if (n < 0) return 0;
+    return write((const uint8_t*)buf, min((size_t)n, sizeof(buf) - 1));
+  }
+};
+
+extern HostSerial Serial;
+
+// Fixed numbers: the host has no heap to report
+struct HostEsp {
+  uint32_t getFreeHeap() const { return 0; }
+  uint32_t getMinFreeHeap() const { return 0; }
+  uint32_t getMaxAllocHeap() const { return 0; }
+  uint32_t getPsramSize() const { return 0; }
+  uint32_t getFreePsram() const { return 0; }
+  uint32_t getMinFreePsram() const { return 0; }
+};
+
+static HostEsp ESP;
+
+// FreeRTOS spinlock stand-in (Stats.h)
+typedef std::mutex portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {}
+#define portENTER_CRITICAL(mux) (mux)->lock()
+#define portEXIT_CRITICAL(mux) (mux)->unlock()
+
+#endif // HOST_ARDUINO_H
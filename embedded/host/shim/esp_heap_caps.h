@@ -0,0 +1,20 @@
+/*
+ * esp_heap_caps.h (host shim)
+ * Capability allocator on the host heap: every region is plain malloc()
+ */
+
+#ifndef HOST_ESP_HEAP_CAPS_H
+#define HOST_ESP_HEAP_CAPS_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#define MALLOC_CAP_8BIT     (1 << 2)
+#define MALLOC_CAP_SPIRAM   (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+
+inline void* heap_caps_malloc(size_t bytes, uint32_t caps) { return malloc(bytes); }
+inline void* heap_caps_realloc(void* ptr, size_t bytes, uint32_t caps) { return realloc(ptr, bytes); }
+inline void heap_caps_free(void* ptr) { free(ptr); }
+
+#endif // HOST_ESP_HEAP_CAPS_H
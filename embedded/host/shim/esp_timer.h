@@ -0,0 +1,13 @@
+/*
+ * esp_timer.h (host shim)
+ * Microsecond timer on the host's steady clock
+ */
+
+#ifndef HOST_ESP_TIMER_H
+#define HOST_ESP_TIMER_H
+
+#include <Arduino.h>
+
+inline int64_t esp_timer_get_time() { return (int64_t)micros(); }
+
+#endif // HOST_ESP_TIMER_H
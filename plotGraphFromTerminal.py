@@ -35,9 +35,35 @@ HEIGHT = HEIGHT + TOP_MARGIN  # Bit-map length for y-axis label + graph area
 GRAPH_WIDTH = int(GRID_Y_SPACING * (Y_MAX / Y_STEP))
 GRAPH_START_X = LEFT_MARGIN  # Grid starts Above the X-axis labels
 GRAPH_START_Y = TOP_MARGIN  # Grid starts BELOW the Y-axis labels
+
+# Serial link
+PRINTER_PORT = "COM7"
+FALLBACK_BAUD = 19200
+BAUD_CANDIDATES = [115200, 57600, 38400, 19200, 9600]  # Fastest first
 # ==============================
 
 
+def detect_baudrate(port, candidates=BAUD_CANDIDATES, probes=3):
+    """Return the fastest rate the printer answers DLE EOT 1 on, or None"""
+    for baud in candidates:
+        try:
+            with serial.Serial(port=port, baudrate=baud, timeout=0.2) as ser:
+                ser.reset_input_buffer()
+                ok = True
+                for _ in range(probes):
+                    ser.write(b"\x10\x04\x01")  # DLE EOT 1 (printer status)
+                    reply = ser.read(1)
+                    # Bit 1 and bit 4 fixed at 1, bits 0 and 7 at 0
+                    if len(reply) != 1 or (reply[0] & 0x93) != 0x12:
+                        ok = False
+                        break
+                if ok:
+                    return baud
+        except serial.SerialException:
+            return None
+    return None
+
+
 class EpsonThermalPrinter:
     def __init__(self, port="COM7", baudrate=19200):
         """Initialize the printer connection"""
@@ -596,8 +622,9 @@ def main():
 
     print("\n[1/4] Connecting to printer...")
     try:
-        printer = EpsonThermalPrinter(port="COM7", baudrate=19200)
-        print("      ✓ Connected")
+        baudrate = detect_baudrate(PRINTER_PORT) or FALLBACK_BAUD
+        printer = EpsonThermalPrinter(port=PRINTER_PORT, baudrate=baudrate)
+        print(f"      ✓ Connected at {baudrate} baud")
     except Exception as e:
         print(f"      ✗ Error: {e}")
         return